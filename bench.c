@@ -0,0 +1,441 @@
+// Benchmark suite for the core loop. Needs no display: it never opens a window.
+// Build with every game source except main.c, e.g.
+//   cc -O2 bench.c coremechanics.c gamemap.c input.c levelgen.c renderer.c replay.c
+//      distfield.c gamelog.c levelpack.c minimap.c profiler.c resources.c rewind.c
+//      save.c scenes.c simulation.c swarm.c raycast.c workpool.c -lraylib -lpthread -lm -o bench
+//
+// Usage: bench [out.json]   (default bench_results.json, summary on stderr)
+//
+// Each benchmark runs over several map sizes and reports ns/op plus heap
+// allocations per op. Allocation counts need glibc (malloc is interposed);
+// elsewhere they are reported as -1.
+#define _GNU_SOURCE
+#include "scenes.h"
+#include "coremechanics.h"
+#include "gamemap.h"
+#include "levelgen.h"
+#include "distfield.h"
+#include "swarm.h"
+#include "raycast.h"
+#include "rewind.h"
+#include "renderer.h"
+#include "rng.h"
+#include "gamelog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ------------------------------------------------------------------
+// ALLOCATION COUNTING
+// ------------------------------------------------------------------
+static long long allocCount = 0;
+static long long allocBytes = 0;
+
+#ifdef __GLIBC__
+#define ALLOCS_TRACKED 1
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    allocCount++;
+    allocBytes += size;
+    return __libc_malloc(size);
+}
+void* calloc(size_t n, size_t size) {
+    allocCount++;
+    allocBytes += n * size;
+    return __libc_calloc(n, size);
+}
+void* realloc(void* ptr, size_t size) {
+    allocCount++;
+    allocBytes += size;
+    return __libc_realloc(ptr, size);
+}
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+#else
+#define ALLOCS_TRACKED 0
+#endif
+
+// ------------------------------------------------------------------
+// HARNESS
+// ------------------------------------------------------------------
+typedef struct BenchResult {
+    const char* name;
+    int mapSize;
+    long iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+} BenchResult;
+
+static BenchResult results[128];
+static int resultCount = 0;
+
+static double NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Per-benchmark timing window; setup outside Start/Stop is not counted
+static double startNs;
+static long long startAllocs, startBytes;
+
+static void BenchStart(void) {
+    startAllocs = allocCount;
+    startBytes = allocBytes;
+    startNs = NowNs();
+}
+
+static void BenchStop(const char* name, int mapSize, long iterations) {
+    double ns = NowNs() - startNs;
+    BenchResult* r = &results[resultCount++];
+    r->name = name;
+    r->mapSize = mapSize;
+    r->iterations = iterations;
+    r->nsPerOp = ns / iterations;
+    r->allocsPerOp = ALLOCS_TRACKED ? (double)(allocCount - startAllocs) / iterations : -1;
+    r->bytesPerOp = ALLOCS_TRACKED ? (double)(allocBytes - startBytes) / iterations : -1;
+    fprintf(stderr, "%-24s size=%-6d %12.1f ns/op %8.2f allocs/op\n",
+            name, mapSize, r->nsPerOp, r->allocsPerOp);
+}
+
+// ------------------------------------------------------------------
+// BENCHMARKS
+// ------------------------------------------------------------------
+#define INPUT_RING 4096
+
+static void BenchInitSceneSystem(int size) {
+    for (int l = 1; l <= 4; l++) ResizeLevelMap(l, size, size);
+    long iterations = 200;
+    BenchStart();
+    for (long i = 0; i < iterations; i++) InitSceneSystem((uint64_t)i + 1);
+    BenchStop("init_scene_system", size, iterations);
+}
+
+static void BenchPregenerate(int size) {
+    long iterations = (size >= 4096) ? 3 : 50;
+    BenchStart();
+    for (long i = 0; i < iterations; i++) {
+        GameMap map;
+        MapInit(&map, size, size, (uint64_t)i + 1);
+        PregenerateMap(&map, GetGenerationThreadCount());
+        MapFree(&map);
+    }
+    BenchStop("pregenerate_map", size, iterations);
+}
+
+static void BenchMovement(int size) {
+    GameMap map;
+    MapInit(&map, size, size, 7);
+    InputFrame inputs[INPUT_RING];
+    Rng rng = RngStream(7, 1);
+    for (int i = 0; i < INPUT_RING; i++) {
+        uint32_t r = RngRange(&rng, 4);
+        inputs[i] = (r == 0) ? CMD_TURN_LEFT : (r == 1) ? CMD_TURN_RIGHT : CMD_STEP;
+    }
+
+    // Exit masks are built with the chunks, as streaming does in the game
+    PregenerateMap(&map, GetGenerationThreadCount());
+    PlayerState p = DefaultSpawn(&map);
+    long iterations = 20000000;
+    BenchStart();
+    for (long i = 0; i < iterations; i++) {
+        HandlePlayerMovement(&p, &map, inputs[i & (INPUT_RING - 1)]);
+    }
+    BenchStop("handle_player_movement", size, iterations);
+    MapFree(&map);
+}
+
+static void BenchCollection(int size) {
+    GameMap map;
+    MapInit(&map, size, size, 9);
+
+    // Precomputed random walk so only the collection check is timed
+    TilePos* walk = malloc(INPUT_RING * sizeof(TilePos));
+    Rng rng = RngStream(9, 2);
+    PlayerState p = DefaultSpawn(&map);
+    for (int i = 0; i < INPUT_RING; i++) {
+        uint32_t r = RngRange(&rng, 4);
+        HandlePlayerMovement(&p, &map, (r == 0) ? CMD_TURN_LEFT : (r == 1) ? CMD_TURN_RIGHT : CMD_STEP);
+        walk[i] = (TilePos){ p.x, p.y };
+    }
+
+    Scene scene = {0};
+    scene.map = &map;
+    int score = 0;
+    int mark = MapMark(&map);
+    long iterations = 10000000;
+    BenchStart();
+    for (long i = 0; i < iterations; i++) {
+        TilePos t = walk[i & (INPUT_RING - 1)];
+        scene.player.x = t.x;
+        scene.player.y = t.y;
+        CheckPointCollection(&scene, &score);
+        if ((i & (INPUT_RING - 1)) == INPUT_RING - 1) MapRollback(&map, mark); // Keep points available
+    }
+    BenchStop("check_point_collection", size, iterations);
+    free(walk);
+    MapFree(&map);
+}
+
+static void BenchSceneRoundTrip(int size) {
+    for (int l = 1; l <= 4; l++) ResizeLevelMap(l, size, size);
+    long iterations = 1000000;
+    BenchStart();
+    for (long i = 0; i < iterations; i++) {
+        // Enter level, pause, resume
+        EnterLevel(1);
+        Scene* s = GetActiveScene();
+        s->input = CMD_PAUSE;
+        s->Update(s);
+        s->input = CMD_PAUSE;
+        s->Update(s);
+    }
+    BenchStop("scene_round_trip", size, iterations);
+}
+
+static void BenchHudText(int size) {
+    Scene scene = {0};
+    scene.type = SCENE_LEVEL;
+    scene.level = 2;
+    scene.player = (PlayerState){ size - 1, size / 2, DIR_WEST };
+    char buf[100];
+    volatile int sink = 0;
+    long iterations = 2000000;
+    BenchStart();
+    for (long i = 0; i < iterations; i++) {
+        FormatHUDText(buf, sizeof(buf), &scene, (int)i);
+        sink += MeasureText(buf, 40);
+    }
+    BenchStop("hud_format_measure", size, iterations);
+}
+
+// ------------------------------------------------------------------
+// MAIN
+// ------------------------------------------------------------------
+static void WriteResults(FILE* out) {
+    fprintf(out, "{\n  \"allocs_tracked\": %s,\n  \"benchmarks\": [\n", ALLOCS_TRACKED ? "true" : "false");
+    for (int i = 0; i < resultCount; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"map_size\": %d, \"iterations\": %ld, "
+                     "\"ns_per_op\": %.2f, \"allocs_per_op\": %.4f, \"bytes_per_op\": %.1f}%s\n",
+                r->name, r->mapSize, r->iterations, r->nsPerOp, r->allocsPerOp, r->bytesPerOp,
+                (i + 1 < resultCount) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+// Full build, then the incremental repair after each claim (in the order the
+// auto-walk would claim them), then the per-step query
+static void BenchDistanceField(int size) {
+    GameMap map;
+    MapInit(&map, size, size, 11);
+    PregenerateMap(&map, GetGenerationThreadCount());
+    DistanceField field = { 0 };
+    int cx = size / 2, cy = size / 2;
+
+    long builds = 5;
+    BenchStart();
+    for (long i = 0; i < builds; i++) {
+        DistFieldInvalidate(&field);
+        DistFieldSync(&field, &map, cx, cy);
+    }
+    BenchStop("distance_field_build", size, builds);
+
+    // Walk the field from the centre, claiming each point reached
+    long claims = 4096;
+    PlayerState p = { cx, cy, DIR_NORTH };
+    BenchStart();
+    for (long i = 0; i < claims; i++) {
+        Direction d;
+        while (DistFieldNextStep(&field, p.x, p.y, &d)) {
+            p.x += (d == DIR_EAST) - (d == DIR_WEST);
+            p.y += (d == DIR_SOUTH) - (d == DIR_NORTH);
+        }
+        if (!MapClaimPoint(&map, p.x, p.y)) break;
+        DistFieldSync(&field, &map, cx, cy);
+    }
+    BenchStop("distance_field_claim", size, claims);
+
+    long queries = 10000000;
+    Rng rng = RngStream(11, 3);
+    TilePos* probes = malloc(INPUT_RING * sizeof(TilePos));
+    for (int i = 0; i < INPUT_RING; i++) {
+        probes[i] = (TilePos){ (int)RngRange(&rng, size), (int)RngRange(&rng, size) };
+    }
+    int found = 0;
+    BenchStart();
+    for (long i = 0; i < queries; i++) {
+        Direction d;
+        TilePos t = probes[i & (INPUT_RING - 1)];
+        found += DistFieldNextStep(&field, t.x, t.y, &d);
+    }
+    BenchStop("distance_field_next_step", size, queries);
+    if (found < 0) printf("%d\n", found); // Keep the loop from being optimized out
+
+    free(probes);
+    DistFieldFree(&field);
+    MapFree(&map);
+}
+
+// Enumerating the remaining points straight from the index, then claiming
+// every point once and rolling the claims back
+static void BenchPointIndex(int size) {
+    GameMap map;
+    MapInit(&map, size, size, 13);
+    PregenerateMap(&map, GetGenerationThreadCount());
+    int total = MapCountPoints(&map, POINTS_ALL);
+    TilePos* points = malloc((total > 0 ? total : 1) * sizeof(TilePos));
+
+    long lists = (size >= 4096) ? 20 : 2000;
+    BenchStart();
+    for (long i = 0; i < lists; i++) MapListPoints(&map, POINTS_REMAINING, points, total);
+    BenchStop("point_index_list", size, lists);
+
+    int mark = MapMark(&map);
+    BenchStart();
+    for (int i = 0; i < total; i++) MapClaimPoint(&map, points[i].x, points[i].y);
+    MapRollback(&map, mark);
+    BenchStop("point_index_claim_undo", size, total);
+
+    free(points);
+    MapFree(&map);
+}
+
+// Recording a random walk's steps, then undoing them one at a time (each
+// undo replays up to a keyframe interval of deltas and rolls back claims)
+static void BenchRewind(int size) {
+    GameMap map;
+    RewindBuffer rw;
+    MapInit(&map, size, size, 19);
+    if (!RewindInit(&rw, REWIND_CAPACITY)) {
+        MapFree(&map);
+        return;
+    }
+    Scene scene = {0};
+    scene.map = &map;
+    scene.player = DefaultSpawn(&map);
+    int score = 0;
+    Rng rng = RngStream(19, 3);
+    RewindReset(&rw, &map, scene.player, score);
+
+    long steps = 0, rounds = 50;
+    BenchStart();
+    for (long r = 0; r < rounds; r++) {
+        while (RewindAvailable(&rw) < REWIND_CAPACITY) {
+            uint32_t k = RngRange(&rng, 4);
+            HandlePlayerMovement(&scene.player, &map, (k == 0) ? CMD_TURN_LEFT : (k == 1) ? CMD_TURN_RIGHT : CMD_STEP);
+            MapStreamAround(&map, scene.player.x, scene.player.y);
+            CheckPointCollection(&scene, &score);
+            RewindRecord(&rw, &map, scene.player, score);
+            steps++;
+        }
+        RewindSteps(&rw, &map, REWIND_CAPACITY, &scene.player, &score);
+    }
+    BenchStop("rewind_walk_record", size, steps);
+
+    while (RewindAvailable(&rw) < REWIND_CAPACITY) {
+        HandlePlayerMovement(&scene.player, &map, RngRange(&rng, 2) ? CMD_STEP : CMD_TURN_RIGHT);
+        CheckPointCollection(&scene, &score);
+        RewindRecord(&rw, &map, scene.player, score);
+    }
+    BenchStart();
+    long undone = 0;
+    while (RewindSteps(&rw, &map, 1, &scene.player, &score) > 0) undone++;
+    BenchStop("rewind_step", size, undone);
+    fprintf(stderr, "rewind history: %d steps in %zu bytes\n", rw.capacity, RewindBytes(&rw));
+
+    RewindFree(&rw);
+    MapFree(&map);
+}
+
+// One agent step per op, on one worker and on every core (the headless
+// --swarm mode prints the full scaling curve)
+static void BenchSwarm(int size, int threads, const char* name) {
+    GameMap map;
+    MapInit(&map, size, size, 17);
+    Swarm* swarm = SwarmCreate(&map, 10000, threads, 17);
+    if (!swarm) {
+        MapFree(&map);
+        return;
+    }
+    long ticks = 200;
+    BenchStart();
+    for (long i = 0; i < ticks; i++) SwarmTick(swarm);
+    BenchStop(name, size, ticks * 10000);
+    SwarmDestroy(swarm);
+    MapFree(&map);
+}
+
+// One full-screen first-person frame per op, on every core
+static void BenchRaycast(int size) {
+    GameMap map;
+    MapInit(&map, size, size, 19);
+    PlayerState spawn = DefaultSpawn(&map);
+    MapStreamAround(&map, spawn.x, spawn.y);
+    Framebuffer fb;
+    WorkPool* pool = PoolCreate(GetGenerationThreadCount());
+    if (!pool || !FramebufferInit(&fb, SCR_WIDTH, SCR_HEIGHT)) {
+        PoolDestroy(pool);
+        MapFree(&map);
+        return;
+    }
+
+    long frames = 200;
+    RayCamera cam = RaycastCameraFor(&spawn);
+    BenchStart();
+    for (long i = 0; i < frames; i++) {
+        cam.angle += 0.01f;
+        RaycastRender(&fb, &map, cam, pool);
+    }
+    BenchStop("raycast_frame", size, frames);
+
+    FramebufferFree(&fb);
+    PoolDestroy(pool);
+    MapFree(&map);
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = (argc > 1) ? argv[1] : "bench_results.json";
+    const int sizes[] = { MAP_WIDTH, 256, 4096 };
+
+    // Logging is asynchronous in the game, so it is here too; the collection
+    // benchmark's pickups mostly land in the drop counter
+    GameLogInit();
+    InitSceneSystem(1);
+    for (int i = 0; i < 3; i++) {
+        BenchInitSceneSystem(sizes[i]);
+        BenchPregenerate(sizes[i]);
+        BenchMovement(sizes[i]);
+        BenchCollection(sizes[i]);
+        BenchSceneRoundTrip(sizes[i]);
+        BenchHudText(sizes[i]);
+    }
+    BenchDistanceField(256);
+    BenchDistanceField(1024);
+    BenchPointIndex(256);
+    BenchPointIndex(4096);
+    BenchRewind(256);
+    BenchSwarm(1024, 1, "swarm_agent_step_1t");
+    BenchSwarm(1024, GetGenerationThreadCount(), "swarm_agent_step_all");
+    BenchRaycast(MAP_WIDTH);
+    BenchRaycast(256);
+    ShutdownSceneSystem();
+    GameLogShutdown();
+
+    FILE* out = fopen(outPath, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", outPath);
+        return 1;
+    }
+    WriteResults(out);
+    fclose(out);
+    fprintf(stderr, "Results written to %s\n", outPath);
+    return 0;
+}
@@ -1,55 +1,67 @@
 #include "coremechanics.h"
-#include <stdio.h>
+#include "gamemap.h"
 
-bool IsValidMove(int x, int y) {
-    return (x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT);
+// Step offsets by Direction
+static const int stepX[4] = { 0, 1, 0, -1 };
+static const int stepY[4] = { -1, 0, 1, 0 };
+
+bool IsValidMove(const GameMap* map, int x, int y) {
+    return !MapIsWall(map, x, y);
 }
 
-bool HandlePlayerMovement(PlayerState* p) {
+bool HandlePlayerMovement(PlayerState* p, const GameMap* map, InputFrame input) {
     bool inputDetected = false;
 
     // Turning
-    if (IsKeyPressed(KEY_A)) {
-        p->facing = (p->facing - 1 + 4) % 4;
+    if (input & CMD_TURN_LEFT) {
+        p->facing = (Direction)((p->facing + 3) & 3);
         inputDetected = true;
     }
-    if (IsKeyPressed(KEY_D)) {
-        p->facing = (p->facing + 1) % 4;
+    if (input & CMD_TURN_RIGHT) {
+        p->facing = (Direction)((p->facing + 1) & 3);
         inputDetected = true;
     }
 
-    // Moving
-    if (IsKeyPressed(KEY_W)) {
-        int tx = p->x; 
-        int ty = p->y;
-        
-        switch (p->facing) {
-            case DIR_NORTH: ty--; break;
-            case DIR_EAST:  tx++; break;
-            case DIR_SOUTH: ty++; break;
-            case DIR_WEST:  tx--; break;
-        }
+    // Moving: the tile's exit mask already knows the edges and walls, so a
+    // step is a lookup by facing and a multiply, with no bounds arithmetic
+    if (input & CMD_STEP) {
+        int open = (MapExits(map, p->x, p->y) >> p->facing) & 1;
+        p->x += stepX[p->facing] * open;
+        p->y += stepY[p->facing] * open;
+        inputDetected |= open;
+    }
+    return inputDetected;
+}
 
-        if (IsValidMove(tx, ty)) {
-            p->x = tx;
-            p->y = ty;
-            inputDetected = true;
+InputFrame SteerTowards(const PlayerState* p, Direction target) {
+    int turn = (target - p->facing + 4) % 4;
+    if (turn == 0) return CMD_STEP;
+    return (turn == 3) ? CMD_TURN_LEFT : CMD_TURN_RIGHT;
+}
+
+PlayerState DefaultSpawn(const GameMap* map) {
+    int cx = (map->width > 5) ? 5 : map->width - 1;
+    int cy = (map->height > 5) ? 5 : map->height - 1;
+    int maxRadius = (map->width > map->height) ? map->width : map->height;
+    // Square rings outward, so authored walls over (5,5) can't strand the player
+    for (int r = 0; r < maxRadius; r++) {
+        for (int y = cy - r; y <= cy + r; y++) {
+            if (y < 0 || y >= map->height) continue;
+            // Rows between the ring's top and bottom only cross its two sides
+            int step = (r == 0 || y == cy - r || y == cy + r) ? 1 : 2 * r;
+            for (int x = cx - r; x <= cx + r; x += step) {
+                if (!MapIsWall(map, x, y)) return (PlayerState){x, y, DIR_NORTH};
+            }
         }
     }
-    return inputDetected;
+    return (PlayerState){cx, cy, DIR_NORTH};
 }
 
-void CheckPointCollection(Scene* scene, int* globalScore, GameMap* globalStoredMap) {
+void CheckPointCollection(Scene* scene, int* globalScore) {
     int x = scene->player.x;
     int y = scene->player.y;
 
-    if (scene->map.tiles[x][y].hasPoint && !scene->map.tiles[x][y].isClaimed) {
-        // Update local scene map
-        scene->map.tiles[x][y].isClaimed = true;
-        // Update global persistence map
-        globalStoredMap->tiles[x][y].isClaimed = true;
-        
-        (*globalScore)++;
-        printf("Point collected! New Score: %d\n", *globalScore);
-    }
+    // The scene map is the stored level map, so one claim persists it. No log
+    // record: the HUD shows the score and the save journals the claim.
+    if (MapClaimPoint(scene->map, x, y)) (*globalScore)++;
 }
\ No newline at end of file
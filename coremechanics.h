@@ -3,14 +3,22 @@
 
 #include "types.h"
 
-// Checks map boundaries
-bool IsValidMove(int x, int y);
+// True if (x, y) is on the map and not a wall
+bool IsValidMove(const GameMap* map, int x, int y);
 
-// Handles W/A/D input and updates player position
+// Applies turn/step commands and updates player position
 // Returns true if the player actually moved/turned
-bool HandlePlayerMovement(PlayerState* p);
+bool HandlePlayerMovement(PlayerState* p, const GameMap* map, InputFrame input);
+
+// The single turn or step command that heads the player towards a direction
+InputFrame SteerTowards(const PlayerState* p, Direction target);
+
+// Default spawn facing north: the open tile nearest (5,5), pulled inside maps
+// smaller than that. A map that is all wall gets (5,5) itself, where every
+// exit is closed.
+PlayerState DefaultSpawn(const GameMap* map);
 
 // Checks if player is standing on a point and updates map/score
-void CheckPointCollection(Scene* scene, int* globalScore, GameMap* globalStoredMap);
+void CheckPointCollection(Scene* scene, int* globalScore);
 
 #endif // COREMECHANICS_H
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "distfield.h"
+#include "gamemap.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Neighbour offsets in Direction order
+static const int stepX[4] = { 0, 1, 0, -1 };
+static const int stepY[4] = { -1, 0, 1, 0 };
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+
+// Exit mask (see MapExits) of window tile (ux, uy)
+static int TileExits(const DistanceField* f, int ux, int uy) {
+    return MapExits(f->map, f->originX + ux, f->originY + uy);
+}
+
+// Window index of the neighbour of window tile (ux, uy) in direction d, or
+// -1 if it's outside the window or the tile's exits don't open that way
+static int Neighbour(const DistanceField* f, int ux, int uy, int exits, int d) {
+    if (!((exits >> d) & 1)) return -1;
+    int tx = ux + stepX[d];
+    int ty = uy + stepY[d];
+    if (tx < 0 || ty < 0 || tx >= f->width || ty >= f->height) return -1;
+    return ty * f->width + tx;
+}
+
+static bool Reserve(DistanceField* f, int tiles) {
+    if (tiles <= f->capacity) return true;
+    int* dist = realloc(f->dist, tiles * sizeof(int));
+    if (dist) f->dist = dist;
+    int* queue = realloc(f->queue, tiles * sizeof(int));
+    if (queue) f->queue = queue;
+    DistEntry* work = realloc(f->work, tiles * sizeof(DistEntry));
+    if (work) f->work = work;
+    if (!dist || !queue || !work) return false;
+    f->capacity = tiles;
+    return true;
+}
+
+// Places the window around (x, y) and runs a multi-source BFS from every
+// unclaimed point in it
+static bool Rebuild(DistanceField* f, GameMap* map, int x, int y) {
+    int w = (map->width < DIST_FIELD_MAX_SIDE) ? map->width : DIST_FIELD_MAX_SIDE;
+    int h = (map->height < DIST_FIELD_MAX_SIDE) ? map->height : DIST_FIELD_MAX_SIDE;
+    if (!Reserve(f, w * h)) {
+        f->map = NULL;
+        return false;
+    }
+
+    int ox = x - w / 2, oy = y - h / 2;
+    if (ox > map->width - w) ox = map->width - w;
+    if (oy > map->height - h) oy = map->height - h;
+    f->originX = (ox < 0) ? 0 : ox;
+    f->originY = (oy < 0) ? 0 : oy;
+    f->width = w;
+    f->height = h;
+    f->map = map;
+    f->claimMark = map->claimLogCount;
+    f->rollbackGen = map->rollbackGen;
+
+    for (int i = 0; i < w * h; i++) f->dist[i] = DIST_UNREACHABLE;
+
+    // Sources a chunk row at a time, straight from the point bitmasks
+    int tail = 0;
+    for (int ty = 0; ty < h; ty++) {
+        int y = f->originY + ty;
+        for (int cx = f->originX & ~(CHUNK_SIZE - 1); cx < f->originX + w; cx += CHUNK_SIZE) {
+            uint64_t bits = MapPointRow(map, cx, y, POINTS_REMAINING);
+            while (bits) {
+                int x = cx + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if (x < f->originX || x >= f->originX + w) continue;
+                int idx = ty * w + (x - f->originX);
+                f->dist[idx] = 0;
+                f->queue[tail++] = idx;
+            }
+        }
+    }
+    for (int head = 0; head < tail; head++) {
+        int u = f->queue[head];
+        int ux = u % w, uy = u / w;
+        int exits = TileExits(f, ux, uy);
+        for (int d = 0; d < 4; d++) {
+            int v = Neighbour(f, ux, uy, exits, d);
+            if (v >= 0 && f->dist[v] == DIST_UNREACHABLE) {
+                f->dist[v] = f->dist[u] + 1;
+                f->queue[tail++] = v;
+            }
+        }
+    }
+    return true;
+}
+
+static int CompareEntries(const void* a, const void* b) {
+    return ((const DistEntry*)a)->dist - ((const DistEntry*)b)->dist;
+}
+
+// Repairs the field after the point at window index src stops being a source.
+// Only tiles whose every shortest path led to src change; they are found by
+// walking outward from src, then refilled from the tiles bordering them.
+static void RemoveSource(DistanceField* f, int src) {
+    if (f->dist[src] != 0) return;
+
+    // 1. Invalidate, layer by layer. A tile keeps its distance if any neighbour
+    //    one step closer survives; by the time a layer is checked, the layer
+    //    before it is final.
+    DistEntry* work = f->work;
+    int count = 0;
+    work[count++] = (DistEntry){ src, 0 };
+    f->dist[src] = DIST_UNREACHABLE;
+    for (int i = 0; i < count; i++) {
+        int u = work[i].index;
+        int ux = u % f->width, uy = u / f->width;
+        int next = work[i].dist + 1;
+        int exits = TileExits(f, ux, uy);
+        for (int d = 0; d < 4; d++) {
+            int v = Neighbour(f, ux, uy, exits, d);
+            if (v < 0 || f->dist[v] != next) continue;
+
+            bool supported = false;
+            int vx = ux + stepX[d], vy = uy + stepY[d];
+            int vExits = TileExits(f, vx, vy);
+            for (int e = 0; e < 4 && !supported; e++) {
+                int w = Neighbour(f, vx, vy, vExits, e);
+                supported = (w >= 0 && f->dist[w] == next - 1);
+            }
+            if (!supported) {
+                f->dist[v] = DIST_UNREACHABLE;
+                work[count++] = (DistEntry){ v, next };
+            }
+        }
+    }
+
+    // 2. Seed each invalidated tile from its intact neighbours, in place
+    int seeds = 0;
+    for (int i = 0; i < count; i++) {
+        int u = work[i].index;
+        int ux = u % f->width, uy = u / f->width;
+        int best = DIST_UNREACHABLE;
+        int exits = TileExits(f, ux, uy);
+        for (int d = 0; d < 4; d++) {
+            int v = Neighbour(f, ux, uy, exits, d);
+            if (v >= 0 && f->dist[v] != DIST_UNREACHABLE && f->dist[v] + 1 < best) best = f->dist[v] + 1;
+        }
+        if (best != DIST_UNREACHABLE) work[seeds++] = (DistEntry){ u, best };
+    }
+    qsort(work, seeds, sizeof(DistEntry), CompareEntries);
+
+    // 3. BFS that merges the sorted seeds in as their distance comes up, so
+    //    every tile is settled once at its final distance
+    int head = 0, tail = 0, s = 0;
+    while (head < tail || s < seeds) {
+        int u;
+        if (head < tail && (s == seeds || f->dist[f->queue[head]] <= work[s].dist)) {
+            u = f->queue[head++];
+        } else {
+            DistEntry seed = work[s++];
+            if (f->dist[seed.index] <= seed.dist) continue;
+            f->dist[seed.index] = seed.dist;
+            u = seed.index;
+        }
+        int ux = u % f->width, uy = u / f->width;
+        int exits = TileExits(f, ux, uy);
+        for (int d = 0; d < 4; d++) {
+            int v = Neighbour(f, ux, uy, exits, d);
+            if (v >= 0 && f->dist[v] > f->dist[u] + 1) {
+                f->dist[v] = f->dist[u] + 1;
+                f->queue[tail++] = v;
+            }
+        }
+    }
+}
+
+// True if the player is close enough to a window edge that has more map
+// beyond it that the window should move
+static bool NeedsRecenter(const DistanceField* f, const GameMap* map, int x, int y) {
+    int mx = f->width / 4, my = f->height / 4;
+    if (x < f->originX + mx && f->originX > 0) return true;
+    if (x >= f->originX + f->width - mx && f->originX + f->width < map->width) return true;
+    if (y < f->originY + my && f->originY > 0) return true;
+    if (y >= f->originY + f->height - my && f->originY + f->height < map->height) return true;
+    return false;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+void DistFieldFree(DistanceField* field) {
+    free(field->dist);
+    free(field->queue);
+    free(field->work);
+    memset(field, 0, sizeof(*field));
+}
+
+void DistFieldInvalidate(DistanceField* field) {
+    field->map = NULL;
+}
+
+bool DistFieldSync(DistanceField* field, GameMap* map, int x, int y) {
+    if (field->map != map || map->rollbackGen != field->rollbackGen || NeedsRecenter(field, map, x, y)) {
+        return Rebuild(field, map, x, y);
+    }
+
+    int count = 0;
+    const TilePos* claims = MapClaimsSince(map, field->claimMark, &count);
+    for (int i = 0; i < count; i++) {
+        int tx = claims[i].x - field->originX;
+        int ty = claims[i].y - field->originY;
+        if (tx < 0 || ty < 0 || tx >= field->width || ty >= field->height) continue;
+        RemoveSource(field, ty * field->width + tx);
+    }
+    field->claimMark = map->claimLogCount;
+    return true;
+}
+
+int DistFieldGet(const DistanceField* field, int x, int y) {
+    int tx = x - field->originX;
+    int ty = y - field->originY;
+    if (!field->map || tx < 0 || ty < 0 || tx >= field->width || ty >= field->height) return DIST_UNREACHABLE;
+    return field->dist[ty * field->width + tx];
+}
+
+bool DistFieldNextStep(const DistanceField* field, int x, int y, Direction* out) {
+    int here = DistFieldGet(field, x, y);
+    if (here == 0 || here == DIST_UNREACHABLE) return false;
+
+    int ux = x - field->originX, uy = y - field->originY;
+    int exits = TileExits(field, ux, uy);
+    for (int d = 0; d < 4; d++) {
+        int v = Neighbour(field, ux, uy, exits, d);
+        if (v >= 0 && field->dist[v] == here - 1) {
+            *out = (Direction)d;
+            return true;
+        }
+    }
+    return false;
+}
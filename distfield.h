@@ -0,0 +1,50 @@
+#ifndef DISTFIELD_H
+#define DISTFIELD_H
+
+#include "types.h"
+
+// Largest window side the field covers. Smaller maps are covered whole; on
+// larger ones the window follows the player and points beyond it are ignored.
+#define DIST_FIELD_MAX_SIDE 1024
+#define DIST_UNREACHABLE 0x7FFFFFFF
+
+typedef struct DistEntry {
+    int index;
+    int dist;
+} DistEntry;
+
+// Steps from every tile in the window to the nearest unclaimed point, moving
+// only through tiles IsValidMove accepts. Claims are picked up from the map's
+// claim log and repaired locally, so only the claimed point's own region is
+// recomputed.
+typedef struct DistanceField {
+    const GameMap* map;   // Map the field was built for, NULL if invalid
+    int originX, originY; // Window position in map tiles
+    int width, height;
+    int claimMark;        // Claim log length already applied
+    int rollbackGen;      // Map's rollback generation at that point
+    int* dist;            // width * height, DIST_UNREACHABLE if no point is reachable
+    int* queue;           // BFS scratch
+    DistEntry* work;      // Repair scratch: invalidated tiles, then reseeds
+    int capacity;         // Tiles the buffers hold
+} DistanceField;
+
+// Releases the buffers; the field can be synced again afterwards
+void DistFieldFree(DistanceField* field);
+
+// Forces a full rebuild on the next sync (e.g. the map was regenerated)
+void DistFieldInvalidate(DistanceField* field);
+
+// Brings the field up to date for a player at (x, y): builds it on first use,
+// after a rollback or when the player nears the window edge, otherwise only
+// repairs around claims made since the last sync. O(1) when nothing changed.
+bool DistFieldSync(DistanceField* field, GameMap* map, int x, int y);
+
+// Steps to the nearest unclaimed point, DIST_UNREACHABLE outside the window
+int DistFieldGet(const DistanceField* field, int x, int y);
+
+// Direction of the first step on a shortest path to the nearest unclaimed
+// point. False if none is reachable or the player is standing on one.
+bool DistFieldNextStep(const DistanceField* field, int x, int y, Direction* out);
+
+#endif // DISTFIELD_H
@@ -0,0 +1,176 @@
+#define _POSIX_C_SOURCE 200809L
+#include "gamelog.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG_RING_RECORDS 1024   // Power of two
+#define LOG_IDLE_SLEEP_NS 2000000
+
+typedef struct LogRecord {
+    const char* fmt;
+    uint64_t time;        // ns on the monotonic clock
+    unsigned char level;
+    unsigned char argCount;
+    LogArg args[GAMELOG_MAX_ARGS];
+} LogRecord;
+
+// Single producer (game thread), single consumer (writer thread). Each side
+// only stores its own index, so neither ever waits on the other.
+static LogRecord ring[LOG_RING_RECORDS];
+static atomic_size_t head = 0;   // Next slot the producer fills
+static atomic_size_t tail = 0;   // Next slot the consumer reads
+static atomic_ulong dropped = 0;
+static atomic_bool running = false;
+static pthread_t writer;
+static uint64_t startTime = 0;
+
+static const char* levelNames[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static uint64_t NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Expands fmt with the recorded arguments. Each conversion is handed to
+// snprintf on its own, with the length modifier swapped for the stored type.
+static int FormatRecord(char* out, int size, const LogRecord* r) {
+    int len = 0, arg = 0;
+    const char* p = r->fmt;
+    while (*p && len < size - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        char spec[32] = "%";
+        int specLen = 1;
+        p++;
+        while (*p && strchr("-+ #0123456789.", *p) && specLen < 24) spec[specLen++] = *p++;
+        while (*p && strchr("hljztL", *p)) p++;
+        char conv = *p ? *p++ : 'd';
+        if (arg >= r->argCount) break;
+        const LogArg* a = &r->args[arg++];
+
+        int room = size - len;
+        int n = 0;
+        if (conv == 's') {
+            spec[specLen++] = 's';
+            spec[specLen] = '\0';
+            n = snprintf(out + len, room, spec, a->type == LOGARG_STRING && a->s ? a->s : "(?)");
+        } else if (strchr("eEfFgGaA", conv)) {
+            spec[specLen++] = conv;
+            spec[specLen] = '\0';
+            n = snprintf(out + len, room, spec, a->type == LOGARG_DOUBLE ? a->d : (double)a->i);
+        } else if (conv == 'c') {
+            spec[specLen++] = 'c';
+            spec[specLen] = '\0';
+            n = snprintf(out + len, room, spec, (int)a->i);
+        } else {
+            spec[specLen++] = 'l';
+            spec[specLen++] = 'l';
+            spec[specLen++] = strchr("uxXo", conv) ? conv : 'd';
+            spec[specLen] = '\0';
+            long long v = a->type == LOGARG_DOUBLE ? (long long)a->d : a->i;
+            n = snprintf(out + len, room, spec, v);
+        }
+        if (n < 0) break;
+        len += (n < room) ? n : room - 1;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static void WriteRecord(const LogRecord* r) {
+    char text[512];
+    FormatRecord(text, sizeof(text), r);
+    double seconds = (r->time - startTime) / 1e9;
+    fprintf(stdout, "[%9.3f] %s %s\n", seconds, levelNames[r->level & 3], text);
+}
+
+static void* WriterThread(void* arg) {
+    unsigned long reportedDrops = 0;
+    for (;;) {
+        size_t t = atomic_load_explicit(&tail, memory_order_relaxed);
+        size_t h = atomic_load_explicit(&head, memory_order_acquire);
+        if (t == h) {
+            bool stopping = !atomic_load(&running);
+            unsigned long drops = atomic_load(&dropped);
+            if (drops != reportedDrops) {
+                fprintf(stdout, "[log] %lu messages dropped (ring full)\n", drops - reportedDrops);
+                reportedDrops = drops;
+            }
+            fflush(stdout);
+            // Anything written before shutdown is visible once running reads false
+            if (stopping) {
+                if (atomic_load_explicit(&head, memory_order_acquire) == t) break;
+                continue;
+            }
+            struct timespec idle = { 0, LOG_IDLE_SLEEP_NS };
+            nanosleep(&idle, NULL);
+            continue;
+        }
+        // Writing happens before the slot is released back to the producer
+        for (; t != h; t++) WriteRecord(&ring[t & (LOG_RING_RECORDS - 1)]);
+        atomic_store_explicit(&tail, t, memory_order_release);
+    }
+    return NULL;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+void GameLogInit(void) {
+    if (atomic_load(&running)) return;
+    if (startTime == 0) startTime = NowNs();
+    atomic_store(&running, true);
+    if (pthread_create(&writer, NULL, WriterThread, NULL) != 0) atomic_store(&running, false);
+}
+
+void GameLogShutdown(void) {
+    if (!atomic_load(&running)) return;
+    // The writer drains the ring before it notices and exits
+    atomic_store(&running, false);
+    pthread_join(writer, NULL);
+}
+
+unsigned long GameLogDropped(void) {
+    return atomic_load(&dropped);
+}
+
+void GameLogWrite(int level, const char* fmt, int argCount, const LogArg* args) {
+    LogRecord r;
+    r.fmt = fmt;
+    r.time = NowNs();
+    r.level = (unsigned char)level;
+    r.argCount = (unsigned char)(argCount > GAMELOG_MAX_ARGS ? GAMELOG_MAX_ARGS : argCount);
+    if (r.argCount) memcpy(r.args, args, r.argCount * sizeof(LogArg));
+
+    if (!atomic_load_explicit(&running, memory_order_relaxed)) {
+        if (startTime == 0) startTime = r.time;
+        WriteRecord(&r);
+        return;
+    }
+
+    size_t h = atomic_load_explicit(&head, memory_order_relaxed);
+    size_t t = atomic_load_explicit(&tail, memory_order_acquire);
+    if (h - t >= LOG_RING_RECORDS) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return;
+    }
+    ring[h & (LOG_RING_RECORDS - 1)] = r;
+    atomic_store_explicit(&head, h + 1, memory_order_release);
+}
@@ -0,0 +1,101 @@
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <stdbool.h>
+
+// Asynchronous logger. The game thread only copies a fixed-size record
+// (format pointer plus up to 4 arguments) into a ring; a background thread
+// formats and writes it, so slow stdout never stalls a frame.
+//
+// Single producer: log from the main thread only. Format strings and %s
+// arguments must outlive the write (string literals or static storage),
+// since only their pointers are queued.
+
+#define GAMELOG_LEVEL_DEBUG 0
+#define GAMELOG_LEVEL_INFO  1
+#define GAMELOG_LEVEL_WARN  2
+#define GAMELOG_LEVEL_ERROR 3
+
+// Calls below this level are compiled out, arguments are never evaluated
+#ifndef GAMELOG_MIN_LEVEL
+#ifdef NDEBUG
+#define GAMELOG_MIN_LEVEL GAMELOG_LEVEL_INFO
+#else
+#define GAMELOG_MIN_LEVEL GAMELOG_LEVEL_DEBUG
+#endif
+#endif
+
+#define GAMELOG_MAX_ARGS 4
+
+typedef enum { LOGARG_INT, LOGARG_DOUBLE, LOGARG_STRING } LogArgType;
+
+typedef struct LogArg {
+    LogArgType type;
+    union {
+        long long i;
+        double d;
+        const char* s;
+    };
+} LogArg;
+
+// Starts the writer thread. Until then (and after shutdown) lines are
+// written synchronously, so tools that never call this still get output.
+void GameLogInit(void);
+
+// Flushes everything queued and stops the writer thread
+void GameLogShutdown(void);
+
+// Records lost because the ring was full
+unsigned long GameLogDropped(void);
+
+void GameLogWrite(int level, const char* fmt, int argCount, const LogArg* args);
+
+static inline LogArg LogArgInt(long long v) { LogArg a = { .type = LOGARG_INT, .i = v }; return a; }
+static inline LogArg LogArgDouble(double v) { LogArg a = { .type = LOGARG_DOUBLE, .d = v }; return a; }
+static inline LogArg LogArgString(const char* v) { LogArg a = { .type = LOGARG_STRING, .s = v }; return a; }
+
+#define GAMELOG_ARG(x) _Generic((x),            \
+    float: LogArgDouble, double: LogArgDouble,  \
+    char*: LogArgString, const char*: LogArgString, \
+    default: LogArgInt)(x)
+
+// Picks GAMELOG_WRITEn by argument count (format string included)
+#define GAMELOG_PICK(_1, _2, _3, _4, _5, name, ...) name
+#define GAMELOG_WRITE(level, ...) GAMELOG_PICK(__VA_ARGS__, GAMELOG_WRITE4, GAMELOG_WRITE3, \
+    GAMELOG_WRITE2, GAMELOG_WRITE1, GAMELOG_WRITE0, unused)(level, __VA_ARGS__)
+#define GAMELOG_WRITE0(level, fmt) GameLogWrite(level, fmt, 0, 0)
+#define GAMELOG_WRITE1(level, fmt, a) \
+    GameLogWrite(level, fmt, 1, (LogArg[]){ GAMELOG_ARG(a) })
+#define GAMELOG_WRITE2(level, fmt, a, b) \
+    GameLogWrite(level, fmt, 2, (LogArg[]){ GAMELOG_ARG(a), GAMELOG_ARG(b) })
+#define GAMELOG_WRITE3(level, fmt, a, b, c) \
+    GameLogWrite(level, fmt, 3, (LogArg[]){ GAMELOG_ARG(a), GAMELOG_ARG(b), GAMELOG_ARG(c) })
+#define GAMELOG_WRITE4(level, fmt, a, b, c, d) \
+    GameLogWrite(level, fmt, 4, (LogArg[]){ GAMELOG_ARG(a), GAMELOG_ARG(b), GAMELOG_ARG(c), GAMELOG_ARG(d) })
+
+// Filtered-out calls still see their arguments (no unused-variable warnings)
+// but the branch is dead and the compiler drops it
+#define GAMELOG_DISCARD(level, ...) do { if (0) GAMELOG_WRITE(level, __VA_ARGS__); } while (0)
+
+// printf-style, e.g. GAMELOG_INFO("Point collected! New Score: %d", score)
+#if GAMELOG_MIN_LEVEL <= GAMELOG_LEVEL_DEBUG
+#define GAMELOG_DEBUG(...) GAMELOG_WRITE(GAMELOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define GAMELOG_DEBUG(...) GAMELOG_DISCARD(GAMELOG_LEVEL_DEBUG, __VA_ARGS__)
+#endif
+
+#if GAMELOG_MIN_LEVEL <= GAMELOG_LEVEL_INFO
+#define GAMELOG_INFO(...) GAMELOG_WRITE(GAMELOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define GAMELOG_INFO(...) GAMELOG_DISCARD(GAMELOG_LEVEL_INFO, __VA_ARGS__)
+#endif
+
+#if GAMELOG_MIN_LEVEL <= GAMELOG_LEVEL_WARN
+#define GAMELOG_WARN(...) GAMELOG_WRITE(GAMELOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define GAMELOG_WARN(...) GAMELOG_DISCARD(GAMELOG_LEVEL_WARN, __VA_ARGS__)
+#endif
+
+#define GAMELOG_ERROR(...) GAMELOG_WRITE(GAMELOG_LEVEL_ERROR, __VA_ARGS__)
+
+#endif // GAMELOG_H
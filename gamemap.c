@@ -0,0 +1,617 @@
+#include "gamemap.h"
+#include "rng.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static int CountRows(const uint64_t* rows) {
+    int count = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++) count += __builtin_popcountll(rows[y]);
+    return count;
+}
+
+// Offsets of the neighbour in each Direction
+static const int exitDX[4] = { 0, 1, 0, -1 };
+static const int exitDY[4] = { -1, 0, 1, 0 };
+
+#define WALL_SALT 0x57414C4C57414C4Cull   // Keeps wall rows apart from the chunks' point streams
+
+// Wall bits of the 64 tiles of chunk column cx in map row y. Tiles off the
+// map read as walls, so exit masks stop at the edges without a bounds test.
+// Generated levels get a pillar on half the tiles whose coordinates are both
+// odd: even rows and columns stay open, so every free tile can reach every
+// other. Depends only on the map's size, seed and layers, so it can be
+// evaluated for chunks that aren't resident, from any thread.
+static uint64_t WallRow(const GameMap* map, int cx, int y) {
+    if (cx < 0 || cx >= map->chunksX || y < 0 || y >= map->height) return ~0ull;
+    int w = map->width - (cx << CHUNK_SHIFT);
+    uint64_t outside = (w >= CHUNK_SIZE) ? 0 : ~((1ull << w) - 1);
+    if (map->walls) return map->walls[(size_t)y * map->chunksX + cx] | outside;
+    if (map->layout || !(y & 1)) return outside;
+    uint64_t bits = RngDerive(map->seed ^ WALL_SALT, ((uint64_t)y << 32) | (uint32_t)cx);
+    return (bits & 0xAAAAAAAAAAAAAAAAull) | outside;
+}
+
+// Moves bit i of the low 16 bits to bit 4i, so four direction masks of 16
+// tiles interleave into one word of nibbles
+static uint64_t SpreadNibbles(uint64_t bits) {
+    bits &= 0xFFFF;
+    bits = (bits | bits << 24) & 0x000000FF000000FFull;
+    bits = (bits | bits << 12) & 0x000F000F000F000Full;
+    bits = (bits | bits << 6) & 0x0303030303030303ull;
+    bits = (bits | bits << 3) & 0x1111111111111111ull;
+    return bits;
+}
+
+// Packs every tile's exit mask from the chunk's wall rows and the edges of
+// its neighbours: bit d of a free tile is set if the tile in Direction d is
+// free too. Walls get no exits. Works on whole rows, 16 tiles per word.
+static void ComputeExits(const GameMap* map, int cx, int cy, MapChunk* chunk) {
+    int y0 = cy << CHUNK_SHIFT;
+    uint64_t above = WallRow(map, cx, y0 - 1);
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        uint64_t walls = chunk->wallRows[y];
+        uint64_t below = (y + 1 < CHUNK_SIZE) ? chunk->wallRows[y + 1] : WallRow(map, cx, y0 + CHUNK_SIZE);
+        uint64_t east = (walls >> 1) | (WallRow(map, cx + 1, y0 + y) << (CHUNK_SIZE - 1));
+        uint64_t west = (walls << 1) | (WallRow(map, cx - 1, y0 + y) >> (CHUNK_SIZE - 1));
+        uint64_t open[4] = { ~walls & ~above, ~walls & ~east, ~walls & ~below, ~walls & ~west };
+        for (int k = 0; k < CHUNK_SIZE / 16; k++) {
+            uint64_t word = 0;
+            for (int d = 0; d < 4; d++) word |= SpreadNibbles(open[d] >> (k * 16)) << d;
+            chunk->exitRows[y][k] = word;
+        }
+        above = walls;
+    }
+}
+
+// Fills a chunk's layers; a chunk always yields the same tiles. Points come
+// from the chunk's own stream: AND-ing three random words gives each tile a
+// 1 in 8 chance, a row at a time. Walls never hold a point.
+static void GenerateChunk(const GameMap* map, int cx, int cy, MapChunk* chunk) {
+    Rng rng = RngStream(map->seed, ((uint64_t)cy << 32) | (uint32_t)cx);
+    int h = map->height - (cy << CHUNK_SHIFT);
+    if (h > CHUNK_SIZE) h = CHUNK_SIZE;
+
+    memset(chunk, 0, sizeof(*chunk));
+    for (int y = 0; y < CHUNK_SIZE; y++) chunk->wallRows[y] = WallRow(map, cx, (cy << CHUNK_SHIFT) + y);
+    ComputeExits(map, cx, cy, chunk);
+    if (map->layout) {
+        // Authored layouts store one word per chunk row, so this is a copy
+        const uint64_t* src = map->layout + (size_t)(cy << CHUNK_SHIFT) * map->chunksX + cx;
+        for (int y = 0; y < h; y++) chunk->pointRows[y] = src[(size_t)y * map->chunksX] & ~chunk->wallRows[y];
+        return;
+    }
+    for (int y = 0; y < h; y++) {
+        uint64_t row = ~0ull;
+        for (int k = 0; k < 3; k++) row &= RngNext(&rng);
+        chunk->pointRows[y] = row & ~chunk->wallRows[y];
+    }
+}
+
+// -- Point index --
+// map->pointIndex holds every generated point. The first
+// pointCount - claimedCount slots are unclaimed, the rest claimed, so claims
+// move a point across the boundary with one swap. Each chunk finds its points'
+// slots through its rank table, which outlives eviction.
+
+static int RemainingSlots(const GameMap* map) {
+    return map->pointCount - map->claimedCount;
+}
+
+static void SetSlot(GameMap* map, int slot, PointRef ref) {
+    map->pointIndex[slot] = ref;
+    ChunkRecord* rec = map->chunks[(ref.y >> CHUNK_SHIFT) * map->chunksX + (ref.x >> CHUNK_SHIFT)];
+    rec->slots[ref.rank] = slot;
+}
+
+static void SwapSlots(GameMap* map, int a, int b) {
+    if (a == b) return;
+    PointRef ra = map->pointIndex[a];
+    SetSlot(map, a, map->pointIndex[b]);
+    SetSlot(map, b, ra);
+}
+
+static void ComputeRowRanks(ChunkRecord* rec) {
+    int rank = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        rec->rowRank[y] = (uint16_t)rank;
+        rank += __builtin_popcountll(rec->tiles->pointRows[y]);
+    }
+}
+
+// Rank of the point on tile (x, y); the chunk must be resident
+static int PointRank(const ChunkRecord* rec, int x, int y) {
+    int row = y & (CHUNK_SIZE - 1);
+    uint64_t before = rec->tiles->pointRows[row] & ((1ull << (x & (CHUNK_SIZE - 1))) - 1);
+    return rec->rowRank[row] + __builtin_popcountll(before);
+}
+
+static bool ReserveIndex(GameMap* map, int count) {
+    if (count <= map->pointIndexCapacity) return true;
+    int newCapacity = map->pointIndexCapacity ? map->pointIndexCapacity : 256;
+    while (newCapacity < count) newCapacity *= 2;
+    PointRef* grown = realloc(map->pointIndex, newCapacity * sizeof(PointRef));
+    if (!grown) return false;
+    map->pointIndex = grown;
+    map->pointIndexCapacity = newCapacity;
+    return true;
+}
+
+// Appends a new unclaimed point and moves it in front of the claimed slots
+static void AppendPoint(GameMap* map, PointRef ref) {
+    int slot = map->pointCount++;
+    SetSlot(map, slot, ref);
+    SwapSlots(map, slot, RemainingSlots(map) - 1);
+}
+
+// Adds a freshly generated chunk's points to the index
+static bool IndexChunk(GameMap* map, int idx, ChunkRecord* rec) {
+    int count = CountRows(rec->tiles->pointRows);
+    rec->slots = malloc((count ? count : 1) * sizeof(int));
+    if (!rec->slots || !ReserveIndex(map, map->pointCount + count)) {
+        free(rec->slots);
+        rec->slots = NULL;
+        return false;
+    }
+    ComputeRowRanks(rec);
+
+    int baseX = (idx % map->chunksX) << CHUNK_SHIFT;
+    int baseY = (idx / map->chunksX) << CHUNK_SHIFT;
+    int rank = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        uint64_t bits = rec->tiles->pointRows[y];
+        while (bits) {
+            int x = __builtin_ctzll(bits);
+            AppendPoint(map, (PointRef){ (uint16_t)(baseX + x), (uint16_t)(baseY + y), (uint16_t)rank++ });
+            bits &= bits - 1;
+        }
+    }
+    rec->pointCount = count;
+    return true;
+}
+
+// Moves a point between the unclaimed and claimed slots. Call before the
+// claimed count changes.
+static void IndexClaim(GameMap* map, ChunkRecord* rec, int x, int y) {
+    SwapSlots(map, rec->slots[PointRank(rec, x, y)], RemainingSlots(map) - 1);
+}
+
+static void IndexUnclaim(GameMap* map, ChunkRecord* rec, int x, int y) {
+    SwapSlots(map, rec->slots[PointRank(rec, x, y)], RemainingSlots(map));
+}
+
+static bool AddResident(GameMap* map, int idx) {
+    if (map->residentCount == map->residentCapacity) {
+        int newCapacity = map->residentCapacity ? map->residentCapacity * 2 : 16;
+        int* grown = realloc(map->resident, newCapacity * sizeof(int));
+        if (!grown) return false;
+        map->resident = grown;
+        map->residentCapacity = newCapacity;
+    }
+    map->resident[map->residentCount++] = idx;
+    return true;
+}
+
+// Makes generated tiles a chunk's resident data: indexes its points the first
+// time and re-applies saved claims after an eviction. Takes ownership of tiles.
+static ChunkRecord* InstallChunk(GameMap* map, int idx, MapChunk* tiles) {
+    ChunkRecord* rec = map->chunks[idx];
+    bool fresh = (rec == NULL);
+    if (fresh) {
+        rec = calloc(1, sizeof(ChunkRecord));
+        if (!rec) {
+            free(tiles);
+            return NULL;
+        }
+        map->chunks[idx] = rec;
+    }
+
+    if (!AddResident(map, idx)) {
+        free(tiles);
+        if (fresh) {
+            free(rec);
+            map->chunks[idx] = NULL;
+        }
+        return NULL;
+    }
+    rec->tiles = tiles;
+
+    if (fresh) {
+        if (!IndexChunk(map, idx, rec)) {
+            map->residentCount--;
+            free(tiles);
+            free(rec);
+            map->chunks[idx] = NULL;
+            return NULL;
+        }
+        map->generatedChunks++;
+    } else {
+        for (int i = 0; i < rec->savedClaimCount; i++) {
+            int off = rec->savedClaims[i];
+            rec->tiles->claimedRows[off >> CHUNK_SHIFT] |= 1ull << (off & (CHUNK_SIZE - 1));
+        }
+        free(rec->savedClaims);
+        rec->savedClaims = NULL;
+        rec->savedClaimCount = 0;
+    }
+    return rec;
+}
+
+static ChunkRecord* MaterializeChunk(GameMap* map, int idx) {
+    MapChunk* tiles = malloc(sizeof(MapChunk));
+    if (!tiles) return NULL;
+    GenerateChunk(map, idx % map->chunksX, idx / map->chunksX, tiles);
+    return InstallChunk(map, idx, tiles);
+}
+
+// Drops a chunk's tiles, keeping only its claims as an offset list
+static void EvictChunk(GameMap* map, int residentSlot) {
+    int idx = map->resident[residentSlot];
+    ChunkRecord* rec = map->chunks[idx];
+
+    if (rec->claimedCount > 0) {
+        rec->savedClaims = malloc(rec->claimedCount * sizeof(uint16_t));
+        if (!rec->savedClaims) return; // Keep it resident rather than lose claims
+        int n = 0;
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            uint64_t bits = rec->tiles->claimedRows[y];
+            while (bits) {
+                rec->savedClaims[n++] = (uint16_t)((y << CHUNK_SHIFT) + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+        rec->savedClaimCount = n;
+    }
+
+    free(rec->tiles);
+    rec->tiles = NULL;
+    map->resident[residentSlot] = map->resident[--map->residentCount];
+}
+
+// Resident chunk holding tile (x, y), or NULL if it couldn't be allocated
+static ChunkRecord* ChunkAt(GameMap* map, int x, int y) {
+    int idx = (y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT);
+    ChunkRecord* rec = map->chunks[idx];
+    if (rec && rec->tiles) return rec;
+    return MaterializeChunk(map, idx);
+}
+
+static void LogClaim(GameMap* map, int x, int y) {
+    if (map->claimLogCount == map->claimLogCapacity) {
+        int newCapacity = map->claimLogCapacity ? map->claimLogCapacity * 2 : 64;
+        TilePos* grown = realloc(map->claimLog, newCapacity * sizeof(TilePos));
+        if (!grown) return;
+        map->claimLog = grown;
+        map->claimLogCapacity = newCapacity;
+    }
+    map->claimLog[map->claimLogCount++] = (TilePos){ x, y };
+}
+
+static void UnclaimPoint(GameMap* map, int x, int y) {
+    ChunkRecord* rec = ChunkAt(map, x, y);
+    if (!rec) return;
+
+    uint64_t* claims = &rec->tiles->claimedRows[y & (CHUNK_SIZE - 1)];
+    uint64_t bit = 1ull << (x & (CHUNK_SIZE - 1));
+    if (!(*claims & bit)) return; // Point was removed since, nothing to undo
+
+    IndexUnclaim(map, rec, x, y);
+    *claims &= ~bit;
+    rec->claimedCount--;
+    map->claimedCount--;
+}
+
+static uint64_t FilterRow(const MapChunk* chunk, PointFilter filter, int y) {
+    switch (filter) {
+        case POINTS_REMAINING: return chunk->pointRows[y] & ~chunk->claimedRows[y];
+        case POINTS_CLAIMED:   return chunk->claimedRows[y];
+        case POINTS_ALL:
+        default:               return chunk->pointRows[y];
+    }
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+bool MapInit(GameMap* map, int width, int height, uint64_t seed) {
+    memset(map, 0, sizeof(*map));
+    if (width < 1 || height < 1 || width > MAP_MAX_SIDE || height > MAP_MAX_SIDE) return false;
+
+    map->width = width;
+    map->height = height;
+    map->chunksX = (width + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    map->chunksY = (height + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    map->seed = seed;
+    map->streamCx = -1;
+    map->streamCy = -1;
+    map->chunks = calloc((size_t)map->chunksX * map->chunksY, sizeof(ChunkRecord*));
+    return map->chunks != NULL;
+}
+
+void MapFree(GameMap* map) {
+    if (map->chunks) {
+        int total = map->chunksX * map->chunksY;
+        for (int i = 0; i < total; i++) {
+            ChunkRecord* rec = map->chunks[i];
+            if (!rec) continue;
+            free(rec->tiles);
+            free(rec->savedClaims);
+            free(rec->slots);
+            free(rec);
+        }
+    }
+    free(map->chunks);
+    free(map->resident);
+    free(map->claimLog);
+    free(map->pointIndex);
+    memset(map, 0, sizeof(*map));
+}
+
+void MapSetLayout(GameMap* map, const uint64_t* points, const uint64_t* walls) {
+    map->layout = points;
+    map->walls = walls;
+}
+
+bool MapChunkResident(const GameMap* map, int chunkIndex) {
+    return map->chunks[chunkIndex] && map->chunks[chunkIndex]->tiles;
+}
+
+void MapGenerateChunkTiles(const GameMap* map, int chunkIndex, MapChunk* out) {
+    GenerateChunk(map, chunkIndex % map->chunksX, chunkIndex / map->chunksX, out);
+}
+
+bool MapInstallChunk(GameMap* map, int chunkIndex, MapChunk* tiles) {
+    if (MapChunkResident(map, chunkIndex)) {
+        free(tiles);
+        return true;
+    }
+    return InstallChunk(map, chunkIndex, tiles) != NULL;
+}
+
+bool MapHasPoint(GameMap* map, int x, int y) {
+    ChunkRecord* rec = ChunkAt(map, x, y);
+    if (!rec) return false;
+    return (rec->tiles->pointRows[y & (CHUNK_SIZE - 1)] >> (x & (CHUNK_SIZE - 1))) & 1u;
+}
+
+bool MapIsClaimed(GameMap* map, int x, int y) {
+    ChunkRecord* rec = ChunkAt(map, x, y);
+    if (!rec) return false;
+    return (rec->tiles->claimedRows[y & (CHUNK_SIZE - 1)] >> (x & (CHUNK_SIZE - 1))) & 1u;
+}
+
+uint64_t MapPointRow(GameMap* map, int x, int y, PointFilter filter) {
+    ChunkRecord* rec = ChunkAt(map, x, y);
+    if (!rec) return 0;
+    return FilterRow(rec->tiles, filter, y & (CHUNK_SIZE - 1));
+}
+
+uint64_t MapPeekPointRow(const GameMap* map, int x, int y, PointFilter filter) {
+    const ChunkRecord* rec = map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+    if (!rec || !rec->tiles) return 0;
+    return FilterRow(rec->tiles, filter, y & (CHUNK_SIZE - 1));
+}
+
+bool MapIsWall(const GameMap* map, int x, int y) {
+    if (!MapInBounds(map, x, y)) return true;
+    const ChunkRecord* rec = map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+    uint64_t row = (rec && rec->tiles) ? rec->tiles->wallRows[y & (CHUNK_SIZE - 1)] : WallRow(map, x >> CHUNK_SHIFT, y);
+    return (row >> (x & (CHUNK_SIZE - 1))) & 1u;
+}
+
+int MapExitsUncached(const GameMap* map, int x, int y) {
+    if (MapIsWall(map, x, y)) return 0;
+    int exits = 0;
+    for (int d = 0; d < 4; d++) exits |= !MapIsWall(map, x + exitDX[d], y + exitDY[d]) << d;
+    return exits;
+}
+
+Tile MapGetTile(GameMap* map, int x, int y) {
+    return (Tile){ MapHasPoint(map, x, y), MapIsClaimed(map, x, y) };
+}
+
+void MapSetPoint(GameMap* map, int x, int y, bool hasPoint) {
+    ChunkRecord* rec = ChunkAt(map, x, y);
+    if (!rec) return;
+
+    uint64_t* points = &rec->tiles->pointRows[y & (CHUNK_SIZE - 1)];
+    uint64_t* claims = &rec->tiles->claimedRows[y & (CHUNK_SIZE - 1)];
+    uint64_t bit = 1ull << (x & (CHUNK_SIZE - 1));
+    if (hasPoint && (rec->tiles->wallRows[y & (CHUNK_SIZE - 1)] & bit)) return;
+    rec->edited = true;
+    if (hasPoint == ((*points & bit) != 0)) return;
+
+    // Points after this one in the chunk change rank, so their slot table
+    // entries shift. O(points in the chunk), which is fine for editing.
+    int rank = PointRank(rec, x, y);
+    if (hasPoint) {
+        int* slots = realloc(rec->slots, (rec->pointCount + 1) * sizeof(int));
+        if (!slots || !ReserveIndex(map, map->pointCount + 1)) {
+            if (slots) rec->slots = slots;
+            return;
+        }
+        rec->slots = slots;
+        for (int r = rec->pointCount; r > rank; r--) {
+            slots[r] = slots[r - 1];
+            map->pointIndex[slots[r]].rank = (uint16_t)r;
+        }
+        *points |= bit;
+        rec->pointCount++;
+        AppendPoint(map, (PointRef){ (uint16_t)x, (uint16_t)y, (uint16_t)rank });
+    } else {
+        if (*claims & bit) {
+            IndexUnclaim(map, rec, x, y);
+            *claims &= ~bit;
+            rec->claimedCount--;
+            map->claimedCount--;
+        }
+        // Last unclaimed slot, then last slot overall, then drop it
+        int last = map->pointCount - 1;
+        SwapSlots(map, rec->slots[rank], RemainingSlots(map) - 1);
+        SwapSlots(map, RemainingSlots(map) - 1, last);
+        map->pointCount--;
+        for (int r = rank; r < rec->pointCount - 1; r++) {
+            rec->slots[r] = rec->slots[r + 1];
+            map->pointIndex[rec->slots[r]].rank = (uint16_t)r;
+        }
+        *points &= ~bit;
+        rec->pointCount--;
+    }
+    ComputeRowRanks(rec);
+}
+
+bool MapClaimPoint(GameMap* map, int x, int y) {
+    ChunkRecord* rec = ChunkAt(map, x, y);
+    if (!rec) return false;
+
+    int row = y & (CHUNK_SIZE - 1);
+    uint64_t bit = 1ull << (x & (CHUNK_SIZE - 1));
+    uint64_t available = rec->tiles->pointRows[row] & ~rec->tiles->claimedRows[row];
+    if (!(available & bit)) return false;
+
+    IndexClaim(map, rec, x, y);
+    rec->tiles->claimedRows[row] |= bit;
+    rec->claimedCount++;
+    map->claimedCount++;
+    LogClaim(map, x, y);
+    return true;
+}
+
+bool MapTryClaimAtomic(GameMap* map, int x, int y) {
+    ChunkRecord* rec = map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+    if (!rec || !rec->tiles) return false;
+
+    int row = y & (CHUNK_SIZE - 1);
+    uint64_t bit = 1ull << (x & (CHUNK_SIZE - 1));
+    if (!(rec->tiles->pointRows[row] & bit)) return false;
+
+    // Neighbouring tiles share the word, so retry until our bit is either set
+    // by us or seen set by someone else
+    uint64_t* word = &rec->tiles->claimedRows[row];
+    uint64_t seen = __atomic_load_n(word, __ATOMIC_RELAXED);
+    while (!(seen & bit)) {
+        if (__atomic_compare_exchange_n(word, &seen, seen | bit, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MapCommitClaims(GameMap* map, const TilePos* claims, int count) {
+    for (int i = 0; i < count; i++) {
+        int x = claims[i].x, y = claims[i].y;
+        ChunkRecord* rec = map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+        IndexClaim(map, rec, x, y);
+        rec->claimedCount++;
+        map->claimedCount++;
+        LogClaim(map, x, y);
+    }
+}
+
+int MapMark(const GameMap* map) {
+    return map->claimLogCount;
+}
+
+void MapRollback(GameMap* map, int mark) {
+    if (mark < 0) mark = 0;
+    if (map->claimLogCount > mark) map->rollbackGen++;
+    while (map->claimLogCount > mark) {
+        TilePos t = map->claimLog[--map->claimLogCount];
+        UnclaimPoint(map, t.x, t.y);
+    }
+}
+
+const TilePos* MapClaimsSince(const GameMap* map, int mark, int* count) {
+    if (mark < 0 || mark > map->claimLogCount) mark = map->claimLogCount;
+    *count = map->claimLogCount - mark;
+    return map->claimLog + mark;
+}
+
+int MapCountPoints(const GameMap* map, PointFilter filter) {
+    switch (filter) {
+        case POINTS_REMAINING: return map->pointCount - map->claimedCount;
+        case POINTS_CLAIMED:   return map->claimedCount;
+        case POINTS_ALL:
+        default:               return map->pointCount;
+    }
+}
+
+int MapListPoints(const GameMap* map, PointFilter filter, TilePos* out, int maxOut) {
+    int first = 0, end = map->pointCount;
+    if (filter == POINTS_REMAINING) end = RemainingSlots(map);
+    if (filter == POINTS_CLAIMED) first = RemainingSlots(map);
+    if (end - first > maxOut) end = first + maxOut;
+
+    for (int i = first; i < end; i++) {
+        out[i - first] = (TilePos){ map->pointIndex[i].x, map->pointIndex[i].y };
+    }
+    return end - first;
+}
+
+bool MapLevelComplete(const GameMap* map) {
+    return map->generatedChunks == map->chunksX * map->chunksY && map->claimedCount == map->pointCount;
+}
+
+void MapResetClaims(GameMap* map) {
+    int total = map->chunksX * map->chunksY;
+    for (int idx = 0; idx < total; idx++) {
+        ChunkRecord* rec = map->chunks[idx];
+        if (!rec) continue;
+        if (rec->tiles) memset(rec->tiles->claimedRows, 0, sizeof(rec->tiles->claimedRows));
+        free(rec->savedClaims);
+        rec->savedClaims = NULL;
+        rec->savedClaimCount = 0;
+        rec->claimedCount = 0;
+    }
+    // Every index slot is now on the unclaimed side, no entries move
+    map->claimedCount = 0;
+    map->claimLogCount = 0;
+    map->rollbackGen++;
+}
+
+void MapStreamAround(GameMap* map, int x, int y) {
+    int cx = x >> CHUNK_SHIFT;
+    int cy = y >> CHUNK_SHIFT;
+    if (cx == map->streamCx && cy == map->streamCy) return;
+    map->streamCx = cx;
+    map->streamCy = cy;
+
+    // Generate the neighbourhood before the player can step into it
+    for (int ny = cy - MAP_STREAM_RADIUS; ny <= cy + MAP_STREAM_RADIUS; ny++) {
+        if (ny < 0 || ny >= map->chunksY) continue;
+        for (int nx = cx - MAP_STREAM_RADIUS; nx <= cx + MAP_STREAM_RADIUS; nx++) {
+            if (nx < 0 || nx >= map->chunksX) continue;
+            int idx = ny * map->chunksX + nx;
+            if (!MapChunkResident(map, idx)) MaterializeChunk(map, idx);
+        }
+    }
+
+    // Walk backwards so swap-removal never skips an entry
+    for (int i = map->residentCount - 1; i >= 0; i--) {
+        int idx = map->resident[i];
+        int dx = abs(idx % map->chunksX - cx);
+        int dy = abs(idx / map->chunksX - cy);
+        if ((dx > MAP_EVICT_RADIUS || dy > MAP_EVICT_RADIUS) && !map->chunks[idx]->edited) {
+            EvictChunk(map, i);
+        }
+    }
+}
+
+size_t MapResidentBytes(const GameMap* map) {
+    size_t bytes = (size_t)map->chunksX * map->chunksY * sizeof(ChunkRecord*);
+    bytes += (size_t)map->residentCapacity * sizeof(int);
+    bytes += (size_t)map->residentCount * sizeof(MapChunk);
+    bytes += (size_t)map->claimLogCapacity * sizeof(TilePos);
+    bytes += (size_t)map->pointIndexCapacity * sizeof(PointRef);
+
+    int total = map->chunksX * map->chunksY;
+    for (int idx = 0; idx < total; idx++) {
+        const ChunkRecord* rec = map->chunks ? map->chunks[idx] : NULL;
+        if (!rec) continue;
+        bytes += sizeof(ChunkRecord) + rec->savedClaimCount * sizeof(uint16_t);
+        bytes += rec->pointCount * sizeof(int);
+    }
+    return bytes;
+}
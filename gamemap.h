@@ -0,0 +1,119 @@
+#ifndef GAMEMAP_H
+#define GAMEMAP_H
+
+#include <stddef.h>
+#include "types.h"
+
+// Which points a list/count query looks at
+typedef enum {
+    POINTS_ALL,
+    POINTS_REMAINING,
+    POINTS_CLAIMED
+} PointFilter;
+
+// Sets up an empty map of the given size. Nothing is generated until used.
+// Returns false if the size is out of range or memory runs out.
+bool MapInit(GameMap* map, int width, int height, uint64_t seed);
+
+// Releases every chunk and the chunk table
+void MapFree(GameMap* map);
+
+// Generates points and walls from authored layers instead of the seed (see
+// levelpack.h for the row layout); either may be NULL. Without a wall layer,
+// generated points come with generated pillars and authored points with no
+// walls. Call before any chunk is generated; the rows must outlive the map
+// since evicted chunks are regenerated from them.
+void MapSetLayout(GameMap* map, const uint64_t* points, const uint64_t* walls);
+
+static inline bool MapInBounds(const GameMap* map, int x, int y) {
+    return (x >= 0 && x < map->width && y >= 0 && y < map->height);
+}
+
+// Chunk-level access for bulk generation (see levelgen.h).
+// MapGenerateChunkTiles only reads the map's size and seed, so it is safe to
+// call from several threads at once. MapInstallChunk takes ownership of
+// malloc'd tiles and must run on the thread that owns the map.
+bool MapChunkResident(const GameMap* map, int chunkIndex);
+void MapGenerateChunkTiles(const GameMap* map, int chunkIndex, MapChunk* out);
+bool MapInstallChunk(GameMap* map, int chunkIndex, MapChunk* tiles);
+
+// Tile queries. Coordinates must be in bounds; touching a chunk generates it.
+bool MapHasPoint(GameMap* map, int x, int y);
+bool MapIsClaimed(GameMap* map, int x, int y);
+Tile MapGetTile(GameMap* map, int x, int y);
+
+// The 64 tiles of the chunk row holding (x, y) as a bitmask, bit i being
+// tile (x & ~(CHUNK_SIZE - 1)) + i, filtered like MapListPoints
+uint64_t MapPointRow(GameMap* map, int x, int y, PointFilter filter);
+
+// Same as MapPointRow but read-only: a chunk that isn't resident reads as
+// empty instead of being generated, so it is safe from several threads while
+// the map isn't being changed
+uint64_t MapPeekPointRow(const GameMap* map, int x, int y, PointFilter filter);
+
+// True for walls and for anything off the map. Read-only: a chunk that isn't
+// resident is worked out from the seed and layers without generating it.
+bool MapIsWall(const GameMap* map, int x, int y);
+
+// MapExits for a tile whose chunk isn't resident, from MapIsWall
+int MapExitsUncached(const GameMap* map, int x, int y);
+
+// Exit mask of in-bounds tile (x, y): bit d is set if a step in Direction d
+// stays on the map and doesn't enter a wall; a wall has none. Precomputed when
+// the chunk is generated, so on resident chunks this is one lookup. Read-only.
+static inline int MapExits(const GameMap* map, int x, int y) {
+    const ChunkRecord* rec = map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+    if (!rec || !rec->tiles) return MapExitsUncached(map, x, y);
+    int lx = x & (CHUNK_SIZE - 1);
+    return (int)(rec->tiles->exitRows[y & (CHUNK_SIZE - 1)][lx >> 4] >> ((lx & 15) << 2)) & 0xF;
+}
+
+// Places or removes a point. Walls can't hold one, placing there does nothing (removing also drops its claim).
+// Edited chunks stay resident since they can no longer be regenerated.
+void MapSetPoint(GameMap* map, int x, int y, bool hasPoint);
+
+// Claims the point on a tile. Returns true only if an unclaimed point was there.
+bool MapClaimPoint(GameMap* map, int x, int y);
+
+// Lock-free claim for parallel updates: only sets the claimed bit, with a
+// compare-and-swap, so of several threads racing for a point exactly one gets
+// true. The chunk must be resident and nothing may stream or edit the map
+// meanwhile. Each winner's tile must then go through MapCommitClaims.
+bool MapTryClaimAtomic(GameMap* map, int x, int y);
+
+// Brings counts, the point index and the claim log up to date for points
+// won with MapTryClaimAtomic. Single-threaded, after the parallel phase.
+void MapCommitClaims(GameMap* map, const TilePos* claims, int count);
+
+// Dirty tracking: every claim is appended to the map's claim log, so taking a
+// snapshot is O(1) (the log length) and never copies tiles.
+int MapMark(const GameMap* map);
+
+// Undoes every claim made after mark, newest first
+void MapRollback(GameMap* map, int mark);
+
+// Claims made since mark. The pointer is valid until the next claim.
+const TilePos* MapClaimsSince(const GameMap* map, int mark, int* count);
+
+// Counts over the chunks generated so far, O(1)
+int MapCountPoints(const GameMap* map, PointFilter filter);
+
+// Writes up to maxOut matching tile positions of generated chunks straight
+// from the point index, O(points written). The order is arbitrary and changes
+// as points are claimed. Returns how many were written.
+int MapListPoints(const GameMap* map, PointFilter filter, TilePos* out, int maxOut);
+
+// True once every chunk has been generated and every point in it claimed, O(1)
+bool MapLevelComplete(const GameMap* map);
+
+// Clears every claim (and the claim log), one word at a time for resident chunks
+void MapResetClaims(GameMap* map);
+
+// Generates the chunks around a tile and evicts the ones far from it.
+// Cheap to call every tick, only does work when the player changes chunk.
+void MapStreamAround(GameMap* map, int x, int y);
+
+// Heap bytes currently held by the map (table, records, resident tiles, saved claims)
+size_t MapResidentBytes(const GameMap* map);
+
+#endif // GAMEMAP_H
@@ -0,0 +1,327 @@
+// Headless driver: runs batches of scripted level sessions with no window.
+// Build without renderer/resources/scenes, e.g.
+//   cc headless.c simulation.c swarm.c raycast.c workpool.c coremechanics.c gamemap.c
+//      levelgen.c levelpack.c rewind.c gamelog.c profiler.c -lpthread -lm -o headless
+//
+// Usage:
+//   headless [sessions] [steps] [seed] [mapSize]
+//                                        random bot sessions, prints throughput
+//   headless --script "wwdww"            single scripted session, prints result
+//                                        ('r' rewinds a step, for scrubbing)
+//   headless --swarm [agents] [ticks] [mapSize] [seed]
+//                                        multi-agent run on 1, 2, 4... cores,
+//                                        prints agent-steps/s and scaling
+//   headless --render [width] [height] [mapSize] [seed] [out.ppm]
+//                                        raycasts the spawn view on one and on
+//                                        every core, prints both hashes, the
+//                                        pixel diff and frame times
+//   headless --pack out.pack [levels] [mapSize]
+//                                        writes a level pack for --levels (every
+//                                        fourth level with an authored ring of
+//                                        points), then maps it back and checks it
+#define _POSIX_C_SOURCE 199309L
+#include "simulation.h"
+#include "swarm.h"
+#include "raycast.h"
+#include "coremechanics.h"
+#include "gamemap.h"
+#include "levelgen.h"
+#include "levelpack.h"
+#include "rng.h"
+#include "gamelog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Random-walk bot: mostly steps, some turns, the occasional pause toggle
+static void GenerateBotInputs(InputFrame* out, int count, Rng* rng) {
+    for (int i = 0; i < count; i++) {
+        uint32_t r = RngRange(rng, 100);
+        if (r < 55)      out[i] = CMD_STEP;
+        else if (r < 75) out[i] = CMD_TURN_LEFT;
+        else if (r < 95) out[i] = CMD_TURN_RIGHT;
+        else if (r < 99) out[i] = CMD_NONE;
+        else             out[i] = CMD_PAUSE;
+    }
+}
+
+static int RunScript(const char* script) {
+    int maxFrames = (int)strlen(script);
+    InputFrame* inputs = malloc(maxFrames > 0 ? maxFrames : 1);
+    int count = SimParseScript(script, inputs, maxFrames);
+
+    SimSession sim;
+    RewindBuffer rewind;
+    SimInitSession(&sim, 1, MAP_WIDTH, MAP_HEIGHT, 0x9E3779B9u);
+    if (RewindInit(&rewind, REWIND_CAPACITY)) {
+        RewindReset(&rewind, sim.scene.map, sim.scene.player, sim.score);
+        sim.rewind = &rewind;
+    }
+    SimRun(&sim, inputs, count);
+
+    printf("ticks=%ld x=%d y=%d facing=%d score=%d paused=%d rewindable=%d rewind_bytes=%zu\n",
+           sim.ticks, sim.scene.player.x, sim.scene.player.y,
+           sim.scene.player.facing, sim.score, sim.paused,
+           RewindAvailable(&rewind), RewindBytes(&rewind));
+    SimFreeSession(&sim);
+    RewindFree(&rewind);
+    free(inputs);
+    return 0;
+}
+
+// One fresh map per thread count, so every run sees the same level and the
+// same agents; only the number of workers changes
+static int RunSwarm(int agents, int ticks, int mapSize, uint64_t seed) {
+    int cores = GetGenerationThreadCount();
+    double baseRate = 0;
+    printf("agents=%d ticks=%d map=%dx%d seed=%llu cores=%d\n", agents, ticks, mapSize, mapSize,
+           (unsigned long long)seed, cores);
+
+    // Doubling, with the full core count as the last step
+    for (int threads = 1; threads <= cores; threads = (threads < cores && threads * 2 > cores) ? cores : threads * 2) {
+        GameMap map;
+        if (!MapInit(&map, mapSize, mapSize, RngDerive(seed, 1))) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        Swarm* swarm = SwarmCreate(&map, agents, threads, seed);
+        if (!swarm) {
+            fprintf(stderr, "out of memory\n");
+            MapFree(&map);
+            return 1;
+        }
+
+        long long claimed = 0;
+        double start = NowSeconds();
+        for (int t = 0; t < ticks; t++) claimed += SwarmTick(swarm);
+        double elapsed = NowSeconds() - start;
+
+        // Every point must be credited to exactly one agent
+        int count;
+        const SwarmAgent* all = SwarmGetAgents(swarm, &count);
+        long long credited = 0;
+        for (int i = 0; i < count; i++) credited += all[i].score;
+
+        double rate = (double)agents * ticks / elapsed;
+        if (threads == 1) baseRate = rate;
+        printf("threads=%-3d agent_steps/s=%-12.0f speedup=%.2fx claimed=%lld/%d steals=%ld%s\n",
+               SwarmThreadCount(swarm), rate, rate / baseRate, claimed, MapCountPoints(&map, POINTS_ALL),
+               SwarmSteals(swarm),
+               (credited == claimed && claimed == MapCountPoints(&map, POINTS_CLAIMED)) ? "" : "  MISMATCH");
+
+        SwarmDestroy(swarm);
+        MapFree(&map);
+    }
+    return 0;
+}
+
+// The spawn view, so the same arguments always give the same image
+static int RunRender(int width, int height, int mapSize, uint64_t seed, const char* outPath) {
+    GameMap map;
+    Framebuffer single, multi;
+    if (!MapInit(&map, mapSize, mapSize, RngDerive(seed, 1)) ||
+        !FramebufferInit(&single, width, height) || !FramebufferInit(&multi, width, height)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    PlayerState spawn = DefaultSpawn(&map);
+    MapStreamAround(&map, spawn.x, spawn.y);
+    RayCamera cam = RaycastCameraFor(&spawn);
+
+    const int frames = 60;
+    double start = NowSeconds();
+    for (int i = 0; i < frames; i++) RaycastRender(&single, &map, cam, NULL);
+    double singleMs = (NowSeconds() - start) * 1000.0 / frames;
+
+    WorkPool* pool = PoolCreate(GetGenerationThreadCount());
+    start = NowSeconds();
+    for (int i = 0; i < frames; i++) RaycastRender(&multi, &map, cam, pool);
+    double multiMs = (NowSeconds() - start) * 1000.0 / frames;
+
+    long diff = FramebufferDiff(&single, &multi);
+    printf("size=%dx%d map=%dx%d threads=%d\n", width, height, mapSize, mapSize, PoolThreadCount(pool));
+    printf("hash=%016llx ms/frame=%.2f (1 thread)\n", (unsigned long long)FramebufferHash(&single), singleMs);
+    printf("hash=%016llx ms/frame=%.2f (%d threads) diff=%ld\n", (unsigned long long)FramebufferHash(&multi),
+           multiMs, PoolThreadCount(pool), diff);
+    if (outPath && !FramebufferWritePPM(&multi, outPath)) fprintf(stderr, "could not write %s\n", outPath);
+
+    PoolDestroy(pool);
+    FramebufferFree(&single);
+    FramebufferFree(&multi);
+    MapFree(&map);
+    return diff == 0 ? 0 : 1;
+}
+
+// Sample content for trying out big registries; real packs come from level tools
+static int RunPack(const char* path, int levelCount, int mapSize) {
+    static const char* backgrounds[4] = {
+        "assets/bg_residence.png", "assets/bg_copse.png", "assets/bg_hospital.png", "assets/bg_dungeon.png"
+    };
+    int stride = LevelLayerStride(mapSize);
+    LevelDef* levels = calloc(levelCount, sizeof(LevelDef));
+    char (*names)[LEVEL_NAME_MAX] = calloc(levelCount, LEVEL_NAME_MAX);
+    uint64_t* ring = calloc((size_t)stride * mapSize, sizeof(uint64_t));
+    uint64_t* walls = calloc((size_t)stride * mapSize, sizeof(uint64_t));
+    if (!levels || !names || !ring || !walls) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (int y = 0; y < mapSize; y++) {
+        for (int x = 0; x < mapSize; x++) {
+            if (x == 0 || y == 0 || x == mapSize - 1 || y == mapSize - 1) {
+                ring[(size_t)y * stride + (x >> CHUNK_SHIFT)] |= 1ull << (x & (CHUNK_SIZE - 1));
+            }
+        }
+    }
+    int mid = mapSize / 2;
+    // A pillar at the centre and a wall row over the default spawn, which has
+    // to find an open tile elsewhere
+    int spawnRow = (mapSize > 5) ? 5 : mapSize - 1;
+    if (mapSize > 2) {
+        walls[(size_t)mid * stride + (mid >> CHUNK_SHIFT)] |= 1ull << (mid & (CHUNK_SIZE - 1));
+        for (int x = 0; x <= 5 && x < mapSize; x++) {
+            walls[(size_t)spawnRow * stride + (x >> CHUNK_SHIFT)] |= 1ull << (x & (CHUNK_SIZE - 1));
+        }
+    }
+    for (int i = 0; i < levelCount; i++) {
+        snprintf(names[i], LEVEL_NAME_MAX, "Sector %d", i + 1);
+        levels[i] = (LevelDef){ names[i], backgrounds[i % 4], mapSize, mapSize, 0,
+                                { -1, -1, DIR_NORTH }, (i % 4 == 3) ? ring : NULL, (i % 4 == 3) ? walls : NULL };
+    }
+    bool written = LevelPackWrite(path, levels, levelCount);
+
+    // Read it back the way the game does and compare a map built from each level
+    int bad = 0;
+    double start = NowSeconds();
+    bool loaded = written && LoadLevelRegistry(path);
+    double loadMs = (NowSeconds() - start) * 1000.0;
+    for (int i = 0; loaded && i < levelCount; i++) {
+        LevelDef def;
+        GameMap map;
+        if (!GetLevelDef(i + 1, &def) || strcmp(def.name, names[i]) != 0 ||
+            (def.points != NULL) != (levels[i].points != NULL) || (def.walls != NULL) != (levels[i].walls != NULL) ||
+            !MapInit(&map, def.width, def.height, 1)) {
+            bad++;
+            continue;
+        }
+        if (def.points) {
+            MapSetLayout(&map, def.points, def.walls);
+            PlayerState spawn = DefaultSpawn(&map);
+            bad += MapHasPoint(&map, mid, 0) != true;
+            bad += (mapSize > 2 && (MapHasPoint(&map, mid, mid) || IsValidMove(&map, mid, mid)));
+            bad += (mapSize > 2 && (!IsValidMove(&map, spawn.x, spawn.y) || MapExits(&map, spawn.x, spawn.y) == 0));
+        }
+        MapFree(&map);
+    }
+    printf("levels=%d map=%dx%d written=%s mapped=%s load_ms=%.3f bad=%d\n", levelCount, mapSize, mapSize,
+           written ? "yes" : "no", loaded ? "yes" : "no", loadMs, bad);
+    UnloadLevelRegistry();
+    free(levels);
+    free(names);
+    free(ring);
+    free(walls);
+    return (loaded && bad == 0) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    GameLogInit();
+    atexit(GameLogShutdown);
+    if (argc >= 3 && strcmp(argv[1], "--script") == 0) {
+        return RunScript(argv[2]);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--swarm") == 0) {
+        int agents = (argc > 2) ? atoi(argv[2]) : 10000;
+        int ticks = (argc > 3) ? atoi(argv[3]) : 1000;
+        int mapSize = (argc > 4) ? atoi(argv[4]) : 1024;
+        uint64_t seed = (argc > 5) ? strtoull(argv[5], NULL, 10) : 1u;
+        if (agents <= 0 || ticks <= 0 || mapSize <= 0 || mapSize > MAP_MAX_SIDE) {
+            fprintf(stderr, "agents, ticks and mapSize must be positive (mapSize <= %d)\n", MAP_MAX_SIDE);
+            return 1;
+        }
+        return RunSwarm(agents, ticks, mapSize, seed);
+    }
+    if (argc >= 3 && strcmp(argv[1], "--pack") == 0) {
+        int levelCount = (argc > 3) ? atoi(argv[3]) : 500;
+        int mapSize = (argc > 4) ? atoi(argv[4]) : MAP_WIDTH;
+        if (levelCount <= 0 || levelCount > UINT16_MAX || mapSize <= 0 || mapSize > MAP_MAX_SIDE) {
+            fprintf(stderr, "levels must be 1..%d and mapSize 1..%d\n", UINT16_MAX, MAP_MAX_SIDE);
+            return 1;
+        }
+        return RunPack(argv[2], levelCount, mapSize);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--render") == 0) {
+        int width = (argc > 2) ? atoi(argv[2]) : SCR_WIDTH;
+        int height = (argc > 3) ? atoi(argv[3]) : SCR_HEIGHT;
+        int mapSize = (argc > 4) ? atoi(argv[4]) : MAP_WIDTH;
+        uint64_t seed = (argc > 5) ? strtoull(argv[5], NULL, 10) : 1u;
+        if (width <= 0 || height <= 1 || mapSize <= 0 || mapSize > MAP_MAX_SIDE) {
+            fprintf(stderr, "width, height and mapSize must be positive (mapSize <= %d)\n", MAP_MAX_SIDE);
+            return 1;
+        }
+        return RunRender(width, height, mapSize, seed, (argc > 6) ? argv[6] : NULL);
+    }
+
+    int sessions = (argc > 1) ? atoi(argv[1]) : 10000;
+    int steps = (argc > 2) ? atoi(argv[2]) : 1000;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1u;
+    int mapSize = (argc > 4) ? atoi(argv[4]) : MAP_WIDTH;
+    if (sessions <= 0 || steps <= 0 || mapSize <= 0 || mapSize > MAP_MAX_SIDE) {
+        fprintf(stderr, "sessions, steps and mapSize must be positive (mapSize <= %d)\n", MAP_MAX_SIDE);
+        return 1;
+    }
+
+    // Four levels seeded like InitSceneSystem; every session forks one of them
+    // and rolls its claims back afterwards, so no map is ever copied
+    GameMap levels[5];
+    for (int l = 1; l <= 4; l++) {
+        if (!MapInit(&levels[l], mapSize, mapSize, RngDerive(seed, l))) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    InputFrame* inputs = malloc(steps);
+    long long totalScore = 0;
+    size_t peakBytes = 0;
+    double start = NowSeconds();
+
+    for (int i = 0; i < sessions; i++) {
+        // Each session gets its own bot input stream
+        Rng rng = RngStream(seed, (uint64_t)i);
+        GenerateBotInputs(inputs, steps, &rng);
+
+        SimSession sim;
+        GameMap* level = &levels[1 + (i % 4)];
+        SimForkSession(&sim, 1 + (i % 4), level);
+        totalScore += SimRun(&sim, inputs, steps);
+
+        size_t bytes = MapResidentBytes(level);
+        if (bytes > peakBytes) peakBytes = bytes;
+        SimFreeSession(&sim);
+    }
+
+    double elapsed = NowSeconds() - start;
+    double totalSteps = (double)sessions * steps;
+    printf("sessions=%d steps=%d seed=%llu map=%dx%d\n", sessions, steps,
+           (unsigned long long)seed, mapSize, mapSize);
+    printf("elapsed=%.3fs sessions/s=%.0f steps/s=%.0f avg_score=%.2f peak_map_bytes=%zu\n",
+           elapsed, sessions / elapsed, totalSteps / elapsed,
+           (double)totalScore / sessions, peakBytes);
+
+    int leftover = 0;
+    for (int l = 1; l <= 4; l++) {
+        leftover += MapCountPoints(&levels[l], POINTS_CLAIMED);
+        MapFree(&levels[l]);
+    }
+    if (leftover != 0) printf("WARNING: %d claims survived rollback\n", leftover);
+
+    free(inputs);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "input.h"
+#include "replay.h"
+#include "profiler.h"
+
+#define INPUT_QUEUE_SIZE 64   // Presses waiting for a tick; more than this in one go are dropped
+
+// One press, stamped with when the frame loop saw it
+typedef struct InputEvent {
+    InputFrame command;       // A single CMD_ bit
+    Vector2 mouse;            // Pointer position when it was sampled
+    double time;
+} InputEvent;
+
+// Input of the frame being processed, live or replayed
+static InputFrame frameInput = CMD_NONE;
+static Vector2 frameMouse = { 0, 0 };
+
+// Live presses sampled from the devices but not yet handed to a tick, oldest first
+static InputEvent queue[INPUT_QUEUE_SIZE];
+static int queueFirst = 0;
+static int queueCount = 0;
+static Vector2 pendingMouse = { 0, 0 };
+
+// Sample times of presses a tick has applied that are not on screen yet
+static double appliedTimes[INPUT_QUEUE_SIZE];
+static int appliedCount = 0;
+
+static ReplayWriter recorder = { 0 };
+static ReplayReader player = { 0 };
+static bool replaying = false;
+static bool replayFinished = false;
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static InputFrame KeyCommand(int key) {
+    switch (key) {
+        case KEY_A:      return CMD_TURN_LEFT;
+        case KEY_D:      return CMD_TURN_RIGHT;
+        case KEY_W:      return CMD_STEP;
+        case KEY_ESCAPE: return CMD_PAUSE;
+        case KEY_TAB:    return CMD_AUTO_WALK;
+        case KEY_R:      return CMD_REWIND;
+        default:         return CMD_NONE;
+    }
+}
+
+static void PushEvent(InputFrame command, double time) {
+    if (command == CMD_NONE || queueCount == INPUT_QUEUE_SIZE) return;
+    queue[(queueFirst + queueCount++) % INPUT_QUEUE_SIZE] = (InputEvent){ command, pendingMouse, time };
+}
+
+// Whether a press can join a tick that already applies frame without
+// changing the order things happen in. A level tick turns before it steps
+// and ends early on pause or rewind, so only distinct turns followed by a
+// step share one; anything else waits for the next tick.
+static bool CanShareTick(InputFrame frame, InputFrame command) {
+    const InputFrame turns = CMD_TURN_LEFT | CMD_TURN_RIGHT;
+    if (frame & ~turns) return false;
+    return command == CMD_STEP || ((command & turns) && !(frame & command));
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+InputFrame PollInputFrame(void) {
+    if (replaying) {
+        ReplayFrame frame;
+        if (ReplayReadFrame(&player, &frame)) {
+            frameInput = frame.input;
+            frameMouse = (Vector2){ (float)frame.mouseX, (float)frame.mouseY };
+        } else {
+            frameInput = CMD_NONE;
+            replayFinished = true;
+        }
+        return frameInput;
+    }
+
+    // Presses go out in the order they came, each to exactly one tick, so a
+    // burst inside one slow frame plays out over the next ticks instead of
+    // collapsing into one
+    InputFrame input = CMD_NONE;
+    Vector2 mouse = pendingMouse;
+    while (queueCount > 0) {
+        const InputEvent* e = &queue[queueFirst];
+        if (input != CMD_NONE && !CanShareTick(input, e->command)) break;
+        input |= e->command;
+        mouse = e->mouse;
+        if (appliedCount < INPUT_QUEUE_SIZE) appliedTimes[appliedCount++] = e->time;
+        queueFirst = (queueFirst + 1) % INPUT_QUEUE_SIZE;
+        queueCount--;
+    }
+
+    frameInput = input;
+    frameMouse = mouse;
+    ReplayWriteFrame(&recorder, (ReplayFrame){ input, (int)frameMouse.x, (int)frameMouse.y });
+    return input;
+}
+
+void SampleInputDevices(double now) {
+    if (replaying) return;
+
+    // raylib's key queue keeps every press since the last poll, where
+    // IsKeyPressed would report a double tap as one
+    pendingMouse = GetMousePosition();
+    for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) PushEvent(KeyCommand(key), now);
+    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) PushEvent(CMD_CLICK, now);
+}
+
+bool InputPending(void) {
+    return queueCount > 0;
+}
+
+void InputFramePresented(double now) {
+    for (int i = 0; i < appliedCount; i++) ProfileInputLatency((now - appliedTimes[i]) * 1000.0);
+    appliedCount = 0;
+}
+
+Vector2 GetInputMousePosition(void) {
+    return frameMouse;
+}
+
+bool GuiButtonPressed(Button btn) {
+    return (frameInput & CMD_CLICK) && CheckCollisionPointRec(frameMouse, btn.rect);
+}
+
+// ------------------------------------------------------------------
+// RECORD / REPLAY
+// ------------------------------------------------------------------
+bool StartInputRecording(const char* path, uint64_t seed) {
+    return ReplayOpenWriter(&recorder, path, seed);
+}
+
+void StopInputRecording(void) {
+    ReplayCloseWriter(&recorder);
+}
+
+bool StartInputReplay(const char* path, uint64_t* seedOut) {
+    if (!ReplayOpenReader(&player, path)) return false;
+    *seedOut = player.seed;
+    replaying = true;
+    replayFinished = false;
+    return true;
+}
+
+void StopInputReplay(void) {
+    ReplayCloseReader(&player);
+    replaying = false;
+}
+
+bool IsReplayActive(void) {
+    return replaying;
+}
+
+bool IsReplayFinished(void) {
+    return replayFinished;
+}
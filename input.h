@@ -0,0 +1,42 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "types.h"
+
+// Queues every keyboard (W/A/D/ESC/TAB/R) and mouse press since the last
+// call, stamped with now (seconds, the main loop's clock). Call once per
+// rendered frame; presses are kept until ticks consume them.
+void SampleInputDevices(double now);
+
+// Hands queued presses to one simulation tick as a command frame, oldest
+// first. A tick takes as many as it can apply in their original order (a
+// turn and the step after it, say); a repeated command waits for the next
+// tick, so none are merged or lost. While a replay is playing the frame
+// comes from the recording instead, and while recording every tick is
+// written out. Call once per tick before Update.
+InputFrame PollInputFrame(void);
+
+// True while sampled presses are still waiting for a tick
+bool InputPending(void);
+
+// Call right after EndDrawing: every press applied by the ticks before this
+// frame is now on screen, and its sample-to-present time goes to the profiler
+void InputFramePresented(double now);
+
+// Mouse position captured by the last PollInputFrame
+Vector2 GetInputMousePosition(void);
+
+// True if the button is hovered and was clicked during the current frame
+bool GuiButtonPressed(Button btn);
+
+// Recording captures every polled frame plus the session seed
+bool StartInputRecording(const char* path, uint64_t seed);
+void StopInputRecording(void);
+
+// Replays a recording; the seed it was made with is written to seedOut
+bool StartInputReplay(const char* path, uint64_t* seedOut);
+void StopInputReplay(void);
+bool IsReplayActive(void);
+bool IsReplayFinished(void);
+
+#endif // INPUT_H
@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L
+#include "levelgen.h"
+#include "gamemap.h"
+#include "profiler.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_GEN_THREADS 64
+
+// Shared between the workers of one GenerateChunksParallel call
+typedef struct GenBatch {
+    const ChunkRequest* requests;
+    MapChunk** results;
+    int count;
+    atomic_int next;
+} GenBatch;
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static void* GenWorker(void* arg) {
+    GenBatch* batch = arg;
+    for (;;) {
+        int i = atomic_fetch_add(&batch->next, 1);
+        if (i >= batch->count) break;
+
+        PROFILE_BEGIN("GenerateChunk");
+        MapChunk* tiles = malloc(sizeof(MapChunk));
+        if (tiles) MapGenerateChunkTiles(batch->requests[i].map, batch->requests[i].chunkIndex, tiles);
+        PROFILE_END();
+        batch->results[i] = tiles;
+    }
+    return NULL;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+int GetGenerationThreadCount(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) return 1;
+    return (cores > MAX_GEN_THREADS) ? MAX_GEN_THREADS : (int)cores;
+}
+
+int CollectChunksAround(GameMap* map, int x, int y, int radius, ChunkRequest* out, int maxOut) {
+    int cx = x >> CHUNK_SHIFT;
+    int cy = y >> CHUNK_SHIFT;
+    int count = 0;
+
+    for (int ny = cy - radius; ny <= cy + radius; ny++) {
+        if (ny < 0 || ny >= map->chunksY) continue;
+        for (int nx = cx - radius; nx <= cx + radius; nx++) {
+            if (nx < 0 || nx >= map->chunksX) continue;
+            int idx = ny * map->chunksX + nx;
+            if (MapChunkResident(map, idx) || count >= maxOut) continue;
+            out[count++] = (ChunkRequest){ map, idx };
+        }
+    }
+    return count;
+}
+
+void GenerateChunksParallel(const ChunkRequest* requests, int count, int threadCount) {
+    if (count <= 0) return;
+
+    GenBatch batch;
+    batch.requests = requests;
+    batch.results = calloc(count, sizeof(MapChunk*));
+    batch.count = count;
+    atomic_init(&batch.next, 0);
+    if (!batch.results) return;
+
+    if (threadCount > count) threadCount = count;
+    if (threadCount > MAX_GEN_THREADS) threadCount = MAX_GEN_THREADS;
+
+    // The calling thread works too, so one thread means no spawning at all
+    pthread_t threads[MAX_GEN_THREADS];
+    int started = 0;
+    for (int t = 1; t < threadCount; t++) {
+        if (pthread_create(&threads[started], NULL, GenWorker, &batch) == 0) started++;
+    }
+    GenWorker(&batch);
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // Installing touches map bookkeeping, so it stays on this thread
+    for (int i = 0; i < count; i++) {
+        if (batch.results[i]) MapInstallChunk(requests[i].map, requests[i].chunkIndex, batch.results[i]);
+    }
+    free(batch.results);
+}
+
+void PregenerateMap(GameMap* map, int threadCount) {
+    int total = map->chunksX * map->chunksY;
+    ChunkRequest* requests = malloc(total * sizeof(ChunkRequest));
+    if (!requests) return;
+
+    int count = 0;
+    for (int idx = 0; idx < total; idx++) {
+        if (!MapChunkResident(map, idx)) requests[count++] = (ChunkRequest){ map, idx };
+    }
+    GenerateChunksParallel(requests, count, threadCount);
+    free(requests);
+}
@@ -0,0 +1,27 @@
+#ifndef LEVELGEN_H
+#define LEVELGEN_H
+
+#include "types.h"
+
+// One chunk of one map to generate
+typedef struct ChunkRequest {
+    GameMap* map;
+    int chunkIndex;
+} ChunkRequest;
+
+// Default worker count: online cores, at least 1
+int GetGenerationThreadCount(void);
+
+// Appends requests for every non-resident chunk within radius (in chunks) of a tile.
+// Returns the number of requests written.
+int CollectChunksAround(GameMap* map, int x, int y, int radius, ChunkRequest* out, int maxOut);
+
+// Generates the requested chunks on up to threadCount workers, then installs
+// them on the calling thread in request order. Each chunk draws from its own
+// stream, so the maps come out identical for any thread count.
+void GenerateChunksParallel(const ChunkRequest* requests, int count, int threadCount);
+
+// Eagerly generates every chunk of a map (bots and balancing runs on whole maps)
+void PregenerateMap(GameMap* map, int threadCount);
+
+#endif // LEVELGEN_H
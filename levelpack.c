@@ -0,0 +1,192 @@
+#define _POSIX_C_SOURCE 200809L
+#include "levelpack.h"
+#include "gamelog.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Used when there is no pack, so the game always has something to play
+static const LevelDef builtinLevels[] = {
+    { "Residence", "assets/bg_residence.png", MAP_WIDTH, MAP_HEIGHT, 1, { -1, -1, DIR_NORTH }, NULL, NULL },
+    { "Copse",     "assets/bg_copse.png",     MAP_WIDTH, MAP_HEIGHT, 2, { -1, -1, DIR_NORTH }, NULL, NULL },
+    { "Hospital",  "assets/bg_hospital.png",  MAP_WIDTH, MAP_HEIGHT, 3, { -1, -1, DIR_NORTH }, NULL, NULL },
+    { "Dungeon",   "assets/bg_dungeon.png",   MAP_WIDTH, MAP_HEIGHT, 4, { -1, -1, DIR_NORTH }, NULL, NULL }
+};
+
+// The mapped pack, NULL data while the built-in levels are in use
+static struct {
+    const unsigned char* data;
+    size_t size;
+    const LevelPackEntry* entries;
+    int count;
+} pack = { NULL, 0, NULL, 0 };
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+// A string at offset, NULL unless it ends inside the file
+static const char* PackString(uint32_t offset) {
+    if (offset == 0 || offset >= pack.size) return NULL;
+    const char* s = (const char*)pack.data + offset;
+    return memchr(s, '\0', pack.size - offset) ? s : NULL;
+}
+
+static bool WriteAll(FILE* f, const void* buf, size_t size) {
+    return size == 0 || fwrite(buf, 1, size, f) == size;
+}
+
+static size_t LayerBytes(int width, int height) {
+    return (size_t)LevelLayerStride(width) * height * sizeof(uint64_t);
+}
+
+// The layer at offset for a width x height level. Sets *ok to false if it
+// doesn't fit in the file.
+static const uint64_t* PackLayer(uint32_t offset, int width, int height, bool* ok) {
+    if (offset == 0) return NULL;
+    if (offset % sizeof(uint64_t) != 0 || (size_t)offset + LayerBytes(width, height) > pack.size) {
+        *ok = false;
+        return NULL;
+    }
+    return (const uint64_t*)(pack.data + offset);
+}
+
+// Pads to the next 8-byte boundary and writes a layer there
+static bool WriteLayer(FILE* f, uint32_t offset, const uint64_t* rows, int width, int height) {
+    static const char zeros[8] = { 0 };
+    return WriteAll(f, zeros, offset - (size_t)ftell(f)) && WriteAll(f, rows, LayerBytes(width, height));
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+bool LoadLevelRegistry(const char* path) {
+    UnloadLevelRegistry();
+
+    int fd = path ? open(path, O_RDONLY) : -1;
+    struct stat st;
+    if (fd >= 0 && (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LevelPackHeader))) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd < 0) {
+        GAMELOG_INFO("No level pack, using the %d built-in levels.", LevelCount());
+        return false;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    const LevelPackHeader* h = data;
+    size_t size = (size_t)st.st_size;
+    bool ok = memcmp(h->magic, "TGLP", 4) == 0 && h->version == LEVELPACK_VERSION &&
+              h->levelCount > 0 && h->levelCount <= UINT16_MAX &&
+              h->entriesOffset % sizeof(uint64_t) == 0 &&
+              (size_t)h->entriesOffset + (size_t)h->levelCount * sizeof(LevelPackEntry) <= size;
+    if (!ok) {
+        munmap(data, size);
+        GAMELOG_WARN("Level pack %s is invalid, using the built-in levels.", path);
+        return false;
+    }
+
+    pack.data = data;
+    pack.size = size;
+    pack.entries = (const LevelPackEntry*)(pack.data + h->entriesOffset);
+    pack.count = (int)h->levelCount;
+    GAMELOG_INFO("Level pack %s: %d levels.", path, pack.count);
+    return true;
+}
+
+void UnloadLevelRegistry(void) {
+    if (pack.data) munmap((void*)pack.data, pack.size);
+    memset(&pack, 0, sizeof(pack));
+}
+
+int LevelCount(void) {
+    return pack.data ? pack.count : (int)(sizeof(builtinLevels) / sizeof(builtinLevels[0]));
+}
+
+bool GetLevelDef(int levelNum, LevelDef* out) {
+    if (levelNum < 1 || levelNum > LevelCount()) return false;
+    if (!pack.data) {
+        *out = builtinLevels[levelNum - 1];
+        return true;
+    }
+
+    const LevelPackEntry* e = &pack.entries[levelNum - 1];
+    if (e->width < 1 || e->height < 1 || e->width > MAP_MAX_SIDE || e->height > MAP_MAX_SIDE) return false;
+    out->name = PackString(e->nameOffset);
+    if (!out->name) return false;
+    out->assetPath = PackString(e->assetOffset);
+    out->width = e->width;
+    out->height = e->height;
+    out->seedStream = e->seedStream ? e->seedStream : (uint64_t)levelNum;
+    out->spawn = (PlayerState){ e->spawnX, e->spawnY, (Direction)(e->spawnFacing & 3) };
+    if (e->spawnX >= e->width || e->spawnY < 0 || e->spawnY >= e->height) out->spawn.x = -1;
+
+    bool ok = true;
+    out->points = PackLayer(e->pointsOffset, e->width, e->height, &ok);
+    out->walls = PackLayer(e->wallsOffset, e->width, e->height, &ok);
+    return ok;
+}
+
+bool LevelPackWrite(const char* path, const LevelDef* levels, int count) {
+    if (count < 1 || count > UINT16_MAX) return false;
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    // Entries first, with offsets into the blob that follows them
+    LevelPackEntry* entries = calloc(count, sizeof(LevelPackEntry));
+    if (!entries) return false;
+    LevelPackHeader header = { {'T', 'G', 'L', 'P'}, LEVELPACK_VERSION, (uint32_t)count, sizeof(LevelPackHeader) };
+    size_t offset = sizeof(header) + (size_t)count * sizeof(LevelPackEntry);
+    for (int i = 0; i < count; i++) {
+        const LevelDef* l = &levels[i];
+        LevelPackEntry* e = &entries[i];
+        e->nameOffset = (uint32_t)offset;
+        offset += strlen(l->name) + 1;
+        if (l->assetPath) {
+            e->assetOffset = (uint32_t)offset;
+            offset += strlen(l->assetPath) + 1;
+        }
+        e->width = l->width;
+        e->height = l->height;
+        e->seedStream = l->seedStream;
+        e->spawnX = l->spawn.x;
+        e->spawnY = l->spawn.y;
+        e->spawnFacing = l->spawn.facing;
+        if (l->points) {
+            offset = (offset + 7) & ~(size_t)7;
+            e->pointsOffset = (uint32_t)offset;
+            offset += LayerBytes(l->width, l->height);
+        }
+        if (l->walls) {
+            offset = (offset + 7) & ~(size_t)7;
+            e->wallsOffset = (uint32_t)offset;
+            offset += LayerBytes(l->width, l->height);
+        }
+    }
+    if (offset > UINT32_MAX) {
+        free(entries);
+        return false;
+    }
+
+    FILE* f = fopen(tmpPath, "wb");
+    bool ok = f && WriteAll(f, &header, sizeof(header)) &&
+              WriteAll(f, entries, (size_t)count * sizeof(LevelPackEntry));
+    for (int i = 0; ok && i < count; i++) {
+        const LevelDef* l = &levels[i];
+        ok = WriteAll(f, l->name, strlen(l->name) + 1);
+        if (ok && l->assetPath) ok = WriteAll(f, l->assetPath, strlen(l->assetPath) + 1);
+        if (ok && l->points) ok = WriteLayer(f, entries[i].pointsOffset, l->points, l->width, l->height);
+        if (ok && l->walls) ok = WriteLayer(f, entries[i].wallsOffset, l->walls, l->width, l->height);
+    }
+    free(entries);
+    if (f && fclose(f) != 0) ok = false;
+    if (ok) ok = rename(tmpPath, path) == 0;
+    if (!ok) remove(tmpPath);
+    return ok;
+}
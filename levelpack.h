@@ -0,0 +1,73 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <stddef.h>
+#include "types.h"
+
+// --------------------------------------------------------------------------------------
+// ON-DISK FORMAT (native byte order, fixed-size records)
+// --------------------------------------------------------------------------------------
+// levels.pack   LevelPackHeader, LevelPackEntry[levelCount], then a blob of
+//               NUL-terminated strings and 8-byte aligned point and wall
+//               layers that entries reference by byte offset from the start
+//               of the file.
+// A layer has one uint64_t per chunk row: height rows of
+// (width + CHUNK_SIZE - 1) / CHUNK_SIZE words, bit i of word k being tile
+// k * CHUNK_SIZE + i, so a chunk is generated by copying words.
+#define LEVELPACK_VERSION 2
+#define LEVEL_NAME_MAX 48             // Longest name the menu shows, NUL included
+
+typedef struct LevelPackHeader {
+    char magic[4];                    // "TGLP"
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t entriesOffset;
+} LevelPackHeader;
+
+typedef struct LevelPackEntry {
+    uint32_t nameOffset;
+    uint32_t assetOffset;             // Background image path, 0 for none
+    int32_t width, height;
+    uint64_t seedStream;              // Session seed stream for generated points, 0 = level number
+    int32_t spawnX, spawnY, spawnFacing;  // spawnX < 0 uses DefaultSpawn
+    uint32_t pointsOffset;            // Authored point layer, 0 to generate from the seed
+    uint32_t wallsOffset;             // Authored wall layer, 0 for the default (see MapSetLayout)
+} LevelPackEntry;
+
+// One level as the game sees it. Strings and the layers point into the
+// mapped pack (or static data for the built-in levels) and stay valid until
+// UnloadLevelRegistry, so they can be used as cache keys.
+typedef struct LevelDef {
+    const char* name;
+    const char* assetPath;
+    int width, height;
+    uint64_t seedStream;
+    PlayerState spawn;                // x < 0 uses DefaultSpawn
+    const uint64_t* points;           // NULL: generated
+    const uint64_t* walls;            // NULL: pillars on generated levels, none on authored ones
+} LevelDef;
+
+// Maps the pack at path, or falls back to the built-in levels if it is missing
+// or invalid. Only the header is checked here, entries are checked on use, so
+// startup cost doesn't depend on how many levels the pack holds.
+// Returns true if the pack was used.
+bool LoadLevelRegistry(const char* path);
+
+// Unmaps the pack (Call once at exit, after everything holding a LevelDef)
+void UnloadLevelRegistry(void);
+
+// Number of levels; they are numbered 1..LevelCount()
+int LevelCount(void);
+
+// Fills out level levelNum, O(1). False if out of range or the entry is malformed.
+bool GetLevelDef(int levelNum, LevelDef* out);
+
+// Words per row of a layer for a map this wide
+static inline int LevelLayerStride(int width) {
+    return (width + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+}
+
+// Writes levels as a pack (temp file, then rename). Returns false on failure.
+bool LevelPackWrite(const char* path, const LevelDef* levels, int count);
+
+#endif // LEVELPACK_H
@@ -1,30 +1,226 @@
+#define _POSIX_C_SOURCE 199309L
 #include "raylib.h"
 #include "types.h"
 #include "resources.h"
 #include "scenes.h"
+#include "input.h"
+#include "renderer.h"
+#include "rng.h"
+#include "profiler.h"
+#include "gamelog.h"
+#include "levelpack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
 
-int main(void) {
-    InitWindow(SCR_WIDTH, SCR_HEIGHT, "First Person C Game");
-    SetExitKey(KEY_NULL);
-    SetTargetFPS(60);
+#define DEFAULT_TICK_RATE 60
+#define MAX_TICKS_PER_FRAME 8      // Catch-up limit before the game slows down instead
+#define MAX_FRAME_SECONDS 0.25     // Longer stalls (debugger, window drag) count as this
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void SleepSeconds(double s) {
+    if (s <= 0) return;
+    struct timespec ts = { (time_t)s, (long)((s - (time_t)s) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+// Runs one simulation tick on the active scene. False once a replay has run out.
+static bool RunTick(void) {
+    Scene* active = GetActiveScene();
+    active->input = PollInputFrame();
+    if (IsReplayFinished()) return false;
+
+    active->prevPlayer = active->player;
+    if (active->Update) active->Update(active);
+    return true;
+}
+
+// Options:
+//   --seed N         replays a session's level layouts exactly (and starts a new save)
+//   --record FILE    records every frame's input plus the seed
+//   --replay FILE    plays a recording back instead of reading devices
+//   --headless       with --replay: no window, no drawing, just the scene updates
+//   --tick-rate N    simulation ticks per second (default 60), independent of drawing
+//   --unthrottled    draw without vsync; headless, tick as fast as possible
+//   --trace FILE     writes the profiler's zones as Chrome trace JSON on exit
+//   --levels FILE    level pack to play (default levels.pack, else the built-in levels);
+//                    replays need the pack they were recorded with
+//
+// Keys: F3 toggles the profiler overlay, F4 writes profile_trace.json
+int main(int argc, char** argv) {
+    uint64_t seed = RngMix((uint64_t)time(NULL));
+    bool seedGiven = false;
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    bool headless = false;
+    bool unthrottled = false;
+    int tickRate = DEFAULT_TICK_RATE;
+    const char* tracePath = NULL;
+    const char* levelsPath = "levels.pack";
+    bool showProfiler = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], NULL, 10);
+            seedGiven = true;
+        }
+        else if (strcmp(argv[i], "--record") == 0 && hasValue) recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && hasValue) replayPath = argv[++i];
+        else if (strcmp(argv[i], "--headless") == 0) headless = true;
+        else if (strcmp(argv[i], "--unthrottled") == 0) unthrottled = true;
+        else if (strcmp(argv[i], "--tick-rate") == 0 && hasValue) tickRate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue) tracePath = argv[++i];
+        else if (strcmp(argv[i], "--levels") == 0 && hasValue) levelsPath = argv[++i];
+    }
+
+    // A replay brings its own seed; without one there is nothing to drive a headless run
+    if (replayPath && !StartInputReplay(replayPath, &seed)) {
+        printf("Cannot read replay %s\n", replayPath);
+        return 1;
+    }
+    if (!replayPath) headless = false;
+    GameLogInit();
+    if (tickRate < 1 || tickRate > 1000) tickRate = DEFAULT_TICK_RATE;
+
+    if (!headless) {
+        // Drawing is paced by the display (or not at all); the tick rate is
+        // kept by the accumulator below
+        if (!unthrottled) SetConfigFlags(FLAG_VSYNC_HINT);
+        InitWindow(SCR_WIDTH, SCR_HEIGHT, "First Person C Game");
+        SetExitKey(KEY_NULL);
+        SetTargetFPS(0);
+        LoadGameAssets();
+    }
+    LoadLevelRegistry(levelsPath);
+    InitSceneSystem(seed);
+
+    // Recordings and replays start fresh and leave the save alone, so they reproduce
+    if (!recordPath && !replayPath) OpenSaveGame("savegame", seedGiven);
+    // A restored save brings its own seed, so this is the one the session runs on
+    GAMELOG_INFO("Session seed: %llu", (unsigned long long)GetSessionSeed());
+    if (recordPath && !StartInputRecording(recordPath, seed)) {
+        printf("Cannot write recording %s\n", recordPath);
+    }
 
-    LoadGameAssets();
-    InitSceneSystem();
-    
     ChangeScene(SCENE_MENU_MAIN);
 
-    while (!WindowShouldClose() && !gameShouldClose) {
+    const double tickSeconds = 1.0 / tickRate;
+    long ticks = 0;
+    double start = NowSeconds();
+    double previous = start;
+    double accumulator = 0.0;
+    bool waitForInput = false;     // EndDrawing sleeps until an OS event instead of pacing frames
+    while (!gameShouldClose) {
+        PROFILE_FRAME();
+        if (!headless && WindowShouldClose()) break;
+        UpdateSaveGame();
+
+        if (headless) {
+            // Nothing to draw, so every pass is just one tick
+            PROFILE_BEGIN("Update");
+            bool ticked = RunTick();
+            PROFILE_END();
+            if (!ticked) break;
+            ticks++;
+            // Real-time pacing without a window to vsync against
+            if (!unthrottled) SleepSeconds(start + ticks * tickSeconds - NowSeconds());
+            continue;
+        }
+
+        double now = NowSeconds();
+        double elapsed = now - previous;
+        previous = now;
+        if (elapsed > MAX_FRAME_SECONDS) elapsed = MAX_FRAME_SECONDS;
+        // Time spent asleep on a static scene isn't a backlog; one tick
+        // handles whatever woke us
+        accumulator = waitForInput ? tickSeconds : accumulator + elapsed;
+
+        // raylib polls events inside EndDrawing, just before now was taken
+        SampleInputDevices(now);
+        bool replayDone = false;
+        int steps = 0;
+        PROFILE_BEGIN("Update");
+        while (accumulator >= tickSeconds && steps < MAX_TICKS_PER_FRAME) {
+            if (!RunTick()) {
+                replayDone = true;
+                break;
+            }
+            accumulator -= tickSeconds;
+            ticks++;
+            steps++;
+        }
+        PROFILE_END();
+        if (replayDone) break;
+        // Spiral-of-death guard: when ticks can't keep up, drop the backlog
+        // rather than letting it grow every frame
+        if (accumulator >= tickSeconds) accumulator = fmod(accumulator, tickSeconds);
+
         Scene* active = GetActiveScene();
-        
-        if (active->Update) active->Update(active);
+        active->interpolation = (float)(accumulator / tickSeconds);
+
+        // Debug keys stay out of the InputFrame so recordings don't depend on them
+        if (IsKeyPressed(KEY_F3)) showProfiler = !showProfiler;
+        if (IsKeyPressed(KEY_F4)) ProfileWriteChromeTrace("profile_trace.json");
+
+        UpdateAssetStreaming();
 
+        // A scene that would draw the same frame again (menus with no click or
+        // hover change, nothing loading) presents this one and then sleeps in
+        // EndDrawing until input arrives. Replays feed input without events,
+        // and the profiler overlay changes every frame, so they keep full rate.
+        bool idle = active->idle && !InputPending() && AssetStreamingIdle() && !IsReplayActive() && !showProfiler;
+        if (idle != waitForInput) {
+            if (idle) EnableEventWaiting();
+            else DisableEventWaiting();
+            waitForInput = idle;
+        }
+
+        PROFILE_BEGIN("Draw");
         BeginDrawing();
         ClearBackground(BLACK);
         if (active->Draw) active->Draw(active);
+        if (showProfiler) DrawProfilerOverlay();
+        PROFILE_END();
+        PROFILE_BEGIN("EndDrawing");
         EndDrawing();
+        PROFILE_END();
+        InputFramePresented(NowSeconds());
+    }
+    if (tracePath && !ProfileWriteChromeTrace(tracePath)) {
+        printf("Cannot write trace %s\n", tracePath);
+    }
+    ProfileStats stats = { 0 };
+    ProfileGetStats(&stats);
+    if (stats.latencySamples > 0) {
+        GAMELOG_INFO("Input to present: p50 %.1f ms, p99 %.1f ms over the last %d presses",
+                     stats.latencyP50, stats.latencyP99, stats.latencySamples);
     }
 
-    UnloadGameAssets();
-    CloseWindow();
+    if (replayPath) {
+        double elapsed = NowSeconds() - start;
+        printf("Replay finished: %ld ticks in %.3fs (%.1f ticks/s), score %d\n",
+               ticks, elapsed, elapsed > 0 ? ticks / elapsed : 0.0, globalScore);
+        StopInputReplay();
+    }
+    StopInputRecording();
+
+    CloseSaveGame();
+    ShutdownSceneSystem();
+    if (!headless) {
+        UnloadRendererCache();
+        UnloadGameAssets();
+        CloseWindow();
+    }
+    // Asset paths point into the pack, so it goes after the asset cache
+    UnloadLevelRegistry();
+    GameLogShutdown();
     return 0;
-}
\ No newline at end of file
+}
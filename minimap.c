@@ -0,0 +1,220 @@
+#include "minimap.h"
+#include "coremechanics.h"
+#include "gamemap.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MINIMAP_MERGE_AREA 1024   // Dirty tiles whose bounding box is this small go up as one rect
+
+typedef struct Minimap {
+    const GameMap* map;       // Map the image was built for, NULL if invalid
+    int originX, originY;     // Window position in map tiles
+    int width, height;
+    uint32_t* pixels;         // width * height, RGBA8 like the texture
+    uint32_t* scratch;        // Packed pixels of one dirty rect for upload
+    Texture2D texture;
+    bool loaded;              // texture (and the buffers) allocated
+    int claimMark;            // Claim log length already drawn
+    int rollbackGen;          // Map's rollback generation at that point
+    int playerX, playerY;     // Tile the player pixel is drawn on
+    TilePos dirty[MINIMAP_MAX_DIRTY];
+    int dirtyCount;
+    bool fullUpload;
+} Minimap;
+
+static Minimap minimap = { 0 };
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static uint32_t PackColor(Color c) {
+    return (uint32_t)c.r | ((uint32_t)c.g << 8) | ((uint32_t)c.b << 16) | ((uint32_t)c.a << 24);
+}
+
+static uint32_t TileColor(GameMap* map, int x, int y) {
+    if (!IsValidMove(map, x, y)) return PackColor(BLACK);
+    uint64_t bit = 1ull << (x & (CHUNK_SIZE - 1));
+    if (MapPointRow(map, x, y, POINTS_REMAINING) & bit) return PackColor(GOLD);
+    if (MapPointRow(map, x, y, POINTS_CLAIMED) & bit) return PackColor(BROWN);
+    return PackColor(DARKGRAY);
+}
+
+static bool InWindow(int x, int y) {
+    return x >= minimap.originX && y >= minimap.originY &&
+           x < minimap.originX + minimap.width && y < minimap.originY + minimap.height;
+}
+
+// Recolours one tile and queues it for upload
+static void SetTile(int x, int y, uint32_t color) {
+    if (!InWindow(x, y)) return;
+    minimap.pixels[(y - minimap.originY) * minimap.width + (x - minimap.originX)] = color;
+    if (minimap.fullUpload) return;
+    if (minimap.dirtyCount == MINIMAP_MAX_DIRTY) {
+        minimap.fullUpload = true;
+        return;
+    }
+    minimap.dirty[minimap.dirtyCount++] = (TilePos){ x, y };
+}
+
+static void UnloadBuffers(void) {
+    if (minimap.loaded) UnloadTexture(minimap.texture);
+    free(minimap.pixels);
+    free(minimap.scratch);
+    minimap.pixels = NULL;
+    minimap.scratch = NULL;
+    minimap.loaded = false;
+}
+
+static bool NeedsRecenter(const GameMap* map, int x, int y) {
+    int mx = minimap.width / 4, my = minimap.height / 4;
+    if (x < minimap.originX + mx && minimap.originX > 0) return true;
+    if (x >= minimap.originX + minimap.width - mx && minimap.originX + minimap.width < map->width) return true;
+    if (y < minimap.originY + my && minimap.originY > 0) return true;
+    if (y >= minimap.originY + minimap.height - my && minimap.originY + minimap.height < map->height) return true;
+    return false;
+}
+
+// Centres the window on (x, y) and redraws every pixel in it
+static bool Rebuild(GameMap* map, int x, int y) {
+    int w = (map->width < MINIMAP_MAX_SIDE) ? map->width : MINIMAP_MAX_SIDE;
+    int h = (map->height < MINIMAP_MAX_SIDE) ? map->height : MINIMAP_MAX_SIDE;
+    if (!minimap.loaded || w != minimap.width || h != minimap.height) {
+        UnloadBuffers();
+        minimap.pixels = malloc((size_t)w * h * sizeof(uint32_t));
+        minimap.scratch = malloc((size_t)w * h * sizeof(uint32_t));
+        if (!minimap.pixels || !minimap.scratch) {
+            UnloadBuffers();
+            minimap.map = NULL;
+            return false;
+        }
+        memset(minimap.pixels, 0, (size_t)w * h * sizeof(uint32_t));
+        Image image = { minimap.pixels, w, h, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        minimap.texture = LoadTextureFromImage(image);
+        minimap.loaded = true;
+        minimap.width = w;
+        minimap.height = h;
+    }
+
+    int ox = x - w / 2, oy = y - h / 2;
+    if (ox > map->width - w) ox = map->width - w;
+    if (oy > map->height - h) oy = map->height - h;
+    minimap.originX = (ox < 0) ? 0 : ox;
+    minimap.originY = (oy < 0) ? 0 : oy;
+    minimap.map = map;
+    minimap.claimMark = map->claimLogCount;
+    minimap.rollbackGen = map->rollbackGen;
+
+    // A chunk row at a time, straight from the point bitmasks
+    uint32_t floorColor = PackColor(DARKGRAY), wallColor = PackColor(BLACK);
+    uint32_t pointColor = PackColor(GOLD), claimedColor = PackColor(BROWN);
+    for (int ty = 0; ty < h; ty++) {
+        int my = minimap.originY + ty;
+        uint32_t* row = minimap.pixels + ty * w;
+        for (int cx = minimap.originX & ~(CHUNK_SIZE - 1); cx < minimap.originX + w; cx += CHUNK_SIZE) {
+            uint64_t points = MapPointRow(map, cx, my, POINTS_ALL);
+            uint64_t claimed = MapPointRow(map, cx, my, POINTS_CLAIMED);
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                int mx = cx + i;
+                if (mx < minimap.originX || mx >= minimap.originX + w) continue;
+                uint32_t c = floorColor;
+                if (!IsValidMove(map, mx, my)) c = wallColor;
+                else if ((claimed >> i) & 1u) c = claimedColor;
+                else if ((points >> i) & 1u) c = pointColor;
+                row[mx - minimap.originX] = c;
+            }
+        }
+    }
+    minimap.dirtyCount = 0;
+    minimap.fullUpload = true;
+    minimap.playerX = x;
+    minimap.playerY = y;
+    SetTile(x, y, PackColor(RED));
+    return true;
+}
+
+// Sends the dirty tiles to the texture: their bounding box in one go when it
+// is small, otherwise tile by tile
+static void UploadDirty(void) {
+    if (minimap.fullUpload) {
+        UpdateTexture(minimap.texture, minimap.pixels);
+    } else if (minimap.dirtyCount > 0) {
+        int x0 = minimap.dirty[0].x, y0 = minimap.dirty[0].y, x1 = x0, y1 = y0;
+        for (int i = 1; i < minimap.dirtyCount; i++) {
+            TilePos t = minimap.dirty[i];
+            if (t.x < x0) x0 = t.x;
+            if (t.y < y0) y0 = t.y;
+            if (t.x > x1) x1 = t.x;
+            if (t.y > y1) y1 = t.y;
+        }
+        int bw = x1 - x0 + 1, bh = y1 - y0 + 1;
+        if (bw * bh <= MINIMAP_MERGE_AREA) {
+            for (int y = 0; y < bh; y++) {
+                const uint32_t* src = minimap.pixels + (y0 - minimap.originY + y) * minimap.width + (x0 - minimap.originX);
+                memcpy(minimap.scratch + y * bw, src, bw * sizeof(uint32_t));
+            }
+            Rectangle rect = { (float)(x0 - minimap.originX), (float)(y0 - minimap.originY), (float)bw, (float)bh };
+            UpdateTextureRec(minimap.texture, rect, minimap.scratch);
+        } else {
+            for (int i = 0; i < minimap.dirtyCount; i++) {
+                int tx = minimap.dirty[i].x - minimap.originX, ty = minimap.dirty[i].y - minimap.originY;
+                Rectangle rect = { (float)tx, (float)ty, 1, 1 };
+                UpdateTextureRec(minimap.texture, rect, &minimap.pixels[ty * minimap.width + tx]);
+            }
+        }
+    }
+    minimap.dirtyCount = 0;
+    minimap.fullUpload = false;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+void UpdateMinimap(Scene* scene) {
+    GameMap* map = scene->map;
+    int x = scene->player.x, y = scene->player.y;
+    if (!map) return;
+    PROFILE_BEGIN("Minimap");
+
+    if (minimap.map != map || map->rollbackGen != minimap.rollbackGen || NeedsRecenter(map, x, y)) {
+        if (!Rebuild(map, x, y)) {
+            PROFILE_END();
+            return;
+        }
+    } else {
+        int count = 0;
+        const TilePos* claims = MapClaimsSince(map, minimap.claimMark, &count);
+        for (int i = 0; i < count; i++) SetTile(claims[i].x, claims[i].y, PackColor(BROWN));
+        minimap.claimMark = map->claimLogCount;
+
+        bool moved = (x != minimap.playerX || y != minimap.playerY);
+        if (moved) {
+            SetTile(minimap.playerX, minimap.playerY, TileColor(map, minimap.playerX, minimap.playerY));
+            minimap.playerX = x;
+            minimap.playerY = y;
+        }
+        // A claim is usually on the player's own tile, so it gets re-marked
+        if (moved || count > 0) SetTile(x, y, PackColor(RED));
+    }
+    UploadDirty();
+    PROFILE_END();
+}
+
+void DrawMinimap(int x, int y, int size) {
+    if (!minimap.loaded || !minimap.map) return;
+    int longSide = (minimap.width > minimap.height) ? minimap.width : minimap.height;
+    float scale = (float)size / longSide;
+    Rectangle source = { 0, 0, (float)minimap.width, (float)minimap.height };
+    Rectangle dest = { (float)x, (float)y, minimap.width * scale, minimap.height * scale };
+    DrawRectangle(x - 2, y - 2, (int)dest.width + 4, (int)dest.height + 4, Fade(BLACK, 0.6f));
+    DrawTexturePro(minimap.texture, source, dest, (Vector2){ 0, 0 }, 0.0f, WHITE);
+}
+
+void InvalidateMinimap(void) {
+    minimap.map = NULL;
+}
+
+void UnloadMinimap(void) {
+    UnloadBuffers();
+    memset(&minimap, 0, sizeof(minimap));
+}
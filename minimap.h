@@ -0,0 +1,28 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "types.h"
+
+// Minimap kept as a one-pixel-per-tile image of the map around the player.
+// Claims (picked up from the map's claim log, which CheckPointCollection
+// feeds) and player moves only recolour their own tiles, and only those
+// pixels are uploaded, so the per-frame cost doesn't grow with the map.
+
+#define MINIMAP_MAX_SIDE 256      // Largest window, in tiles; smaller maps are shown whole
+#define MINIMAP_MAX_DIRTY 256     // Tiles queued per frame before a full upload is cheaper
+
+// Brings the image and texture up to date with the scene's map and player.
+// Rebuilds the whole window only on a new map, after a rollback or when the
+// player nears the window edge.
+void UpdateMinimap(Scene* scene);
+
+// Draws the minimap as a single textured quad, size pixels on its long side
+void DrawMinimap(int x, int y, int size);
+
+// Forces a rebuild on the next update (e.g. the map was regenerated)
+void InvalidateMinimap(void);
+
+// Releases the image and texture (Call once at exit, before CloseWindow)
+void UnloadMinimap(void);
+
+#endif // MINIMAP_H
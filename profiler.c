@@ -0,0 +1,255 @@
+#define _POSIX_C_SOURCE 200809L
+#include "profiler.h"
+#include "gamelog.h"
+
+#if PROFILER_ENABLED
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PROFILE_MAX_THREADS 32
+#define PROFILE_RING_EVENTS 4096   // Per thread, oldest events are overwritten
+#define PROFILE_MAX_DEPTH 32
+
+typedef struct ProfileEvent {
+    const char* name;
+    uint64_t start;     // ns since the profiler started
+    uint64_t duration;
+} ProfileEvent;
+
+// One per thread. Only the owning thread writes; exporters read behind head
+// and drop anything the writer may have lapped while they copied.
+typedef struct ProfileRing {
+    atomic_uint_fast64_t head;   // Events ever written
+    atomic_bool inUse;
+    int depth;
+    const char* openNames[PROFILE_MAX_DEPTH];
+    uint64_t openStarts[PROFILE_MAX_DEPTH];
+    ProfileEvent events[PROFILE_RING_EVENTS];
+} ProfileRing;
+
+// Rings are allocated on first use and never freed; a thread that exits
+// hands its ring to the next new thread, which keeps appending to it
+static ProfileRing* _Atomic rings[PROFILE_MAX_THREADS];
+static _Thread_local ProfileRing* threadRing = NULL;
+static pthread_key_t ringKey;
+static pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT;
+static uint64_t epoch = 0;
+
+// Frame data, touched by the main loop thread only
+static double frameTimes[PROFILE_FRAME_WINDOW];
+static int frameCount = 0;
+static int frameNext = 0;
+static uint64_t lastFrameMark = 0;
+static ProfilePhase currentPhases[PROFILE_MAX_PHASES];
+static ProfilePhase lastPhases[PROFILE_MAX_PHASES];
+static int currentPhaseCount = 0;
+static int lastPhaseCount = 0;
+static ProfileRing* frameRing = NULL;
+static double latencies[PROFILE_LATENCY_WINDOW];
+static int latencyCount = 0;
+static int latencyNext = 0;
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static uint64_t NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void ReleaseRing(void* ring) {
+    atomic_store(&((ProfileRing*)ring)->inUse, false);
+}
+
+static void CreateRingKey(void) {
+    pthread_key_create(&ringKey, ReleaseRing);
+    epoch = NowNs();
+}
+
+// Finds a free ring without locking: claim an unused one or publish a new one
+static ProfileRing* AcquireRing(void) {
+    pthread_once(&ringKeyOnce, CreateRingKey);
+
+    for (int i = 0; i < PROFILE_MAX_THREADS; i++) {
+        ProfileRing* ring = atomic_load(&rings[i]);
+        if (!ring) {
+            ProfileRing* fresh = calloc(1, sizeof(ProfileRing));
+            if (!fresh) return NULL;
+            ProfileRing* expected = NULL;
+            if (atomic_compare_exchange_strong(&rings[i], &expected, fresh)) {
+                ring = fresh;
+            } else {
+                free(fresh);
+                ring = expected;
+            }
+        }
+        bool idle = false;
+        if (atomic_compare_exchange_strong(&ring->inUse, &idle, true)) {
+            ring->depth = 0;
+            pthread_setspecific(ringKey, ring);
+            return ring;
+        }
+    }
+    return NULL;   // More live threads than rings, this one goes unprofiled
+}
+
+static void AddPhase(const char* name, uint64_t duration) {
+    double ms = duration / 1e6;
+    for (int i = 0; i < currentPhaseCount; i++) {
+        if (currentPhases[i].name == name) {
+            currentPhases[i].ms += ms;
+            return;
+        }
+    }
+    if (currentPhaseCount < PROFILE_MAX_PHASES) {
+        currentPhases[currentPhaseCount++] = (ProfilePhase){ name, ms };
+    }
+}
+
+static int CompareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Copies the count filled slots of a window ring into sorted, ascending
+static void SortWindow(const double* values, int count, double* sorted) {
+    memcpy(sorted, values, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), CompareDoubles);
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+void ProfileZoneBegin(const char* name) {
+    if (!threadRing) threadRing = AcquireRing();
+    ProfileRing* ring = threadRing;
+    if (!ring) return;
+
+    if (ring->depth < PROFILE_MAX_DEPTH) {
+        ring->openNames[ring->depth] = name;
+        ring->openStarts[ring->depth] = NowNs();
+    }
+    ring->depth++;
+}
+
+void ProfileZoneEnd(void) {
+    ProfileRing* ring = threadRing;
+    if (!ring || ring->depth == 0) return;
+
+    int depth = --ring->depth;
+    if (depth >= PROFILE_MAX_DEPTH) return;
+
+    uint64_t end = NowNs();
+    uint64_t start = ring->openStarts[depth];
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ProfileEvent* e = &ring->events[head % PROFILE_RING_EVENTS];
+    e->name = ring->openNames[depth];
+    e->start = start - epoch;
+    e->duration = end - start;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    if (depth == 0 && ring == frameRing) AddPhase(e->name, e->duration);
+}
+
+void ProfileFrameMark(void) {
+    if (!threadRing) threadRing = AcquireRing();
+    frameRing = threadRing;
+
+    uint64_t now = NowNs();
+    if (lastFrameMark != 0) {
+        frameTimes[frameNext] = (now - lastFrameMark) / 1e6;
+        frameNext = (frameNext + 1) % PROFILE_FRAME_WINDOW;
+        if (frameCount < PROFILE_FRAME_WINDOW) frameCount++;
+    }
+    lastFrameMark = now;
+
+    memcpy(lastPhases, currentPhases, sizeof(lastPhases));
+    lastPhaseCount = currentPhaseCount;
+    currentPhaseCount = 0;
+}
+
+void ProfileInputLatency(double ms) {
+    latencies[latencyNext] = ms;
+    latencyNext = (latencyNext + 1) % PROFILE_LATENCY_WINDOW;
+    if (latencyCount < PROFILE_LATENCY_WINDOW) latencyCount++;
+}
+
+bool ProfileGetStats(ProfileStats* out) {
+    memset(out, 0, sizeof(*out));
+    memcpy(out->phases, lastPhases, sizeof(out->phases));
+    out->phaseCount = lastPhaseCount;
+    if (latencyCount > 0) {
+        double sortedLatency[PROFILE_LATENCY_WINDOW];
+        SortWindow(latencies, latencyCount, sortedLatency);
+        out->latencySamples = latencyCount;
+        out->latencyP50 = sortedLatency[(latencyCount - 1) * 50 / 100];
+        out->latencyP99 = sortedLatency[(latencyCount - 1) * 99 / 100];
+    }
+    if (frameCount == 0) return false;
+
+    double sorted[PROFILE_FRAME_WINDOW];
+    SortWindow(frameTimes, frameCount, sorted);
+
+    out->frames = frameCount;
+    out->p50 = sorted[(frameCount - 1) * 50 / 100];
+    out->p99 = sorted[(frameCount - 1) * 99 / 100];
+    out->max = sorted[frameCount - 1];
+    for (int i = 0; i < frameCount; i++) {
+        int bucket = (int)(frameTimes[i] / PROFILE_HIST_BUCKET_MS);
+        if (bucket >= PROFILE_HIST_BUCKETS) bucket = PROFILE_HIST_BUCKETS - 1;
+        out->histogram[bucket]++;
+    }
+    return true;
+}
+
+bool ProfileWriteChromeTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    ProfileEvent* copy = malloc(sizeof(ProfileEvent) * PROFILE_RING_EVENTS);
+    if (!copy) {
+        fclose(file);
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    long written = 0;
+    for (int t = 0; t < PROFILE_MAX_THREADS; t++) {
+        ProfileRing* ring = atomic_load(&rings[t]);
+        if (!ring) continue;
+
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint64_t oldest = head > PROFILE_RING_EVENTS ? head - PROFILE_RING_EVENTS : 0;
+        for (uint64_t i = oldest; i < head; i++) copy[i - oldest] = ring->events[i % PROFILE_RING_EVENTS];
+
+        // Whatever the writer reached meanwhile may have overwritten our oldest
+        // copies, and it fills slot `after` before publishing it, so that one too
+        uint64_t after = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint64_t begin = after >= PROFILE_RING_EVENTS ? after - PROFILE_RING_EVENTS + 1 : 0;
+        if (begin < oldest) begin = oldest;
+
+        for (uint64_t i = begin; i < head; i++) {
+            const ProfileEvent* e = &copy[i - oldest];
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", e->name, t + 1, e->start / 1e3, e->duration / 1e3);
+            first = false;
+            written++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    free(copy);
+
+    bool ok = (fclose(file) == 0);
+    if (ok) GAMELOG_INFO("Profile trace: %ld zones written to %s", written, path);
+    return ok;
+}
+
+#endif // PROFILER_ENABLED
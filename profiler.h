@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+// Build with -DPROFILER_ENABLED=0 to compile every zone and frame mark out
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#define PROFILE_FRAME_WINDOW 240   // Frames the overlay statistics cover
+#define PROFILE_HIST_BUCKETS 17    // 2 ms wide, the last one is 32 ms and up
+#define PROFILE_HIST_BUCKET_MS 2.0
+#define PROFILE_MAX_PHASES 8
+#define PROFILE_LATENCY_WINDOW 256 // Input events the latency percentiles cover
+
+// Time spent in one top-level zone during the last frame
+typedef struct ProfilePhase {
+    const char* name;
+    double ms;
+} ProfilePhase;
+
+typedef struct ProfileStats {
+    int frames;                 // Frames in the window (up to PROFILE_FRAME_WINDOW)
+    double p50, p99, max;       // Frame time in ms
+    int histogram[PROFILE_HIST_BUCKETS];
+    ProfilePhase phases[PROFILE_MAX_PHASES];
+    int phaseCount;
+    int latencySamples;         // Input events in the window (up to PROFILE_LATENCY_WINDOW)
+    double latencyP50, latencyP99;  // Input-to-present time in ms
+} ProfileStats;
+
+#if PROFILER_ENABLED
+
+// Opens a zone on the calling thread. name must outlive the profiler
+// (a string literal); zones nest and are closed by ProfileZoneEnd.
+void ProfileZoneBegin(const char* name);
+void ProfileZoneEnd(void);
+
+// Ends a frame: records its duration and the top-level zones inside it.
+// Call from the main loop thread only.
+void ProfileFrameMark(void);
+
+// Records how long one input event took from being sampled to being on
+// screen. Call from the main loop thread only.
+void ProfileInputLatency(double ms);
+
+// Frame-time percentiles and histogram over the last PROFILE_FRAME_WINDOW
+// frames, input latency percentiles over the last PROFILE_LATENCY_WINDOW events
+bool ProfileGetStats(ProfileStats* out);
+
+// Writes every buffered zone of every thread as Chrome trace JSON
+// (load it in chrome://tracing or Perfetto)
+bool ProfileWriteChromeTrace(const char* path);
+
+#define PROFILE_BEGIN(name) ProfileZoneBegin(name)
+#define PROFILE_END() ProfileZoneEnd()
+#define PROFILE_FRAME() ProfileFrameMark()
+
+#else
+
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+static inline void ProfileInputLatency(double ms) { (void)ms; }
+static inline bool ProfileGetStats(ProfileStats* out) { (void)out; return false; }
+static inline bool ProfileWriteChromeTrace(const char* path) { (void)path; return false; }
+
+#endif // PROFILER_ENABLED
+
+#endif // PROFILER_H
@@ -0,0 +1,271 @@
+#include "raycast.h"
+#include "coremechanics.h"
+#include "gamemap.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define RAYCAST_BAND_COLUMNS 16   // Columns a worker takes at a time
+#define RAYCAST_MAX_MARKERS 16    // Points drawn per column, nearest first
+#define MARKER_HALF_WIDTH 0.15f   // In tiles
+#define MARKER_HEIGHT 0.3f
+
+// One frame's shared state. Workers take bands off the counter, so the split
+// adapts to uneven columns (walls close by are cheap, open floor is not).
+typedef struct RenderJob {
+    Framebuffer* fb;
+    const GameMap* map;
+    RayCamera cam;
+    float dirX, dirY;
+    float planeX, planeY;
+    float invDet;             // For projecting markers into camera space
+    atomic_int nextColumn;
+} RenderJob;
+
+typedef struct Marker {
+    float depth;
+    float screenX;
+    float halfWidth;          // In pixels
+} Marker;
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static inline uint32_t PackRGBA(int r, int g, int b, int a) {
+    return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | ((uint32_t)a << 24);
+}
+
+// Darkens a colour with distance so far walls and floor fade to black
+static inline uint32_t Shade(int r, int g, int b, float depth) {
+    float f = 1.0f / (1.0f + depth * 0.12f);
+    return PackRGBA((int)(r * f), (int)(g * f), (int)(b * f), 255);
+}
+
+static void FillSpan(uint32_t* dst, int count, uint32_t color) {
+    int i = 0;
+#ifdef __SSE2__
+    __m128i v = _mm_set1_epi32((int)color);
+    for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v);
+#endif
+    for (; i < count; i++) dst[i] = color;
+}
+
+// Transparent ceiling, then floor rows shaded by the distance they show
+static void BuildGradient(Framebuffer* fb) {
+    int h = fb->height;
+    for (int y = 0; y < h; y++) {
+        if (y <= h / 2) {
+            fb->gradient[y] = 0;
+        } else {
+            float depth = (float)h / (2.0f * (y - h / 2.0f));
+            fb->gradient[y] = Shade(70, 62, 52, depth);
+        }
+    }
+}
+
+static bool RemainingPointAt(const GameMap* map, int x, int y) {
+    return (MapPeekPointRow(map, x, y, POINTS_REMAINING) >> (x & (CHUNK_SIZE - 1))) & 1u;
+}
+
+// Screen position and size of the marker on tile (tx, ty), false if it is
+// behind the camera or this column's ray misses it
+static bool ProjectMarker(const RenderJob* job, int tx, int ty, int column, Marker* out) {
+    float sx = tx + 0.5f - job->cam.x;
+    float sy = ty + 0.5f - job->cam.y;
+    float camX = job->invDet * (job->dirY * sx - job->dirX * sy);
+    float depth = job->invDet * (-job->planeY * sx + job->planeX * sy);
+    if (depth < 0.2f) return false;
+
+    int w = job->fb->width;
+    out->depth = depth;
+    out->screenX = (w / 2.0f) * (1.0f + camX / depth);
+    // The camera plane spans half the screen width at depth 1
+    out->halfWidth = MARKER_HALF_WIDTH * (w / 2.0f) / (RAYCAST_FOV_PLANE * depth);
+    return fabsf(column + 0.5f - out->screenX) < out->halfWidth;
+}
+
+static void CastColumn(const RenderJob* job, int column) {
+    Framebuffer* fb = job->fb;
+    int h = fb->height;
+    uint32_t* out = fb->columns + (size_t)column * h;
+
+    float camX = 2.0f * (column + 0.5f) / fb->width - 1.0f;
+    float rayX = job->dirX + job->planeX * camX;
+    float rayY = job->dirY + job->planeY * camX;
+
+    int mapX = (int)floorf(job->cam.x);
+    int mapY = (int)floorf(job->cam.y);
+    float deltaX = (rayX == 0.0f) ? 1e30f : fabsf(1.0f / rayX);
+    float deltaY = (rayY == 0.0f) ? 1e30f : fabsf(1.0f / rayY);
+    int stepX = (rayX < 0) ? -1 : 1;
+    int stepY = (rayY < 0) ? -1 : 1;
+    float sideX = (rayX < 0) ? (job->cam.x - mapX) * deltaX : (mapX + 1.0f - job->cam.x) * deltaX;
+    float sideY = (rayY < 0) ? (job->cam.y - mapY) * deltaY : (mapY + 1.0f - job->cam.y) * deltaY;
+
+    // DDA until a wall or the fade-out distance, noting markers on the way
+    Marker markers[RAYCAST_MAX_MARKERS];
+    int markerCount = 0;
+    float wallDepth = 0;
+    int side = 0;
+    bool hit = false;
+    for (;;) {
+        if (sideX < sideY) {
+            wallDepth = sideX;
+            sideX += deltaX;
+            mapX += stepX;
+            side = 0;
+        } else {
+            wallDepth = sideY;
+            sideY += deltaY;
+            mapY += stepY;
+            side = 1;
+        }
+        if (wallDepth > RAYCAST_MAX_DEPTH) break;
+        if (!IsValidMove(job->map, mapX, mapY)) {
+            hit = true;
+            break;
+        }
+        if (markerCount < RAYCAST_MAX_MARKERS && RemainingPointAt(job->map, mapX, mapY) &&
+            ProjectMarker(job, mapX, mapY, column, &markers[markerCount])) {
+            markerCount++;
+        }
+    }
+
+    // Ceiling, wall, floor
+    int top = h / 2, bottom = h / 2;
+    if (hit) {
+        int lineHeight = (wallDepth > 0.0f) ? (int)(h / wallDepth) : h;
+        if (lineHeight > h) lineHeight = h;
+        top = (h - lineHeight) / 2;
+        bottom = top + lineHeight;
+        int base = side ? 96 : 128;
+        FillSpan(out + top, bottom - top, Shade(base, base, base + 16, wallDepth));
+    }
+    memcpy(out, fb->gradient, top * sizeof(uint32_t));
+    memcpy(out + bottom, fb->gradient + bottom, (h - bottom) * sizeof(uint32_t));
+
+    // Markers stand on the floor; far ones first so near ones cover them
+    for (int i = markerCount - 1; i >= 0; i--) {
+        const Marker* m = &markers[i];
+        float floorY = h / 2.0f + h / (2.0f * m->depth);
+        int y1 = (int)floorY;
+        int y0 = (int)(floorY - MARKER_HEIGHT * h / m->depth);
+        if (y0 < 0) y0 = 0;
+        if (y1 > h) y1 = h;
+        if (y1 > y0) FillSpan(out + y0, y1 - y0, Shade(255, 203, 0, m->depth));
+    }
+}
+
+// Copies a band of finished columns into the row-major pixels. A band is 16
+// pixels wide, so each row it writes is one whole cache line.
+static void ResolveBand(Framebuffer* fb, int first, int end) {
+    int w = fb->width, h = fb->height;
+    const uint32_t* src = fb->columns + (size_t)first * h;
+    for (int y = 0; y < h; y++) {
+        uint32_t* row = fb->pixels + (size_t)y * w + first;
+        for (int c = 0; c < end - first; c++) row[c] = src[(size_t)c * h + y];
+    }
+}
+
+// Each band is cast and resolved while its columns are still in cache
+static void CastJob(void* ctx, int worker) {
+    RenderJob* job = ctx;
+    int w = job->fb->width;
+    for (;;) {
+        int first = atomic_fetch_add_explicit(&job->nextColumn, RAYCAST_BAND_COLUMNS, memory_order_relaxed);
+        if (first >= w) break;
+        int end = (first + RAYCAST_BAND_COLUMNS < w) ? first + RAYCAST_BAND_COLUMNS : w;
+        for (int x = first; x < end; x++) CastColumn(job, x);
+        ResolveBand(job->fb, first, end);
+    }
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+bool FramebufferInit(Framebuffer* fb, int width, int height) {
+    memset(fb, 0, sizeof(*fb));
+    if (width < 1 || height < 2) return false;
+    fb->width = width;
+    fb->height = height;
+    // Line-aligned so bands never share a cache line between workers
+    size_t bytes = ((size_t)width * height * sizeof(uint32_t) + 63) & ~(size_t)63;
+    fb->pixels = aligned_alloc(64, bytes);
+    fb->columns = calloc((size_t)width * height, sizeof(uint32_t));
+    if (fb->pixels) memset(fb->pixels, 0, bytes);
+    fb->gradient = malloc(height * sizeof(uint32_t));
+    if (!fb->pixels || !fb->columns || !fb->gradient) {
+        FramebufferFree(fb);
+        return false;
+    }
+    BuildGradient(fb);
+    return true;
+}
+
+void FramebufferFree(Framebuffer* fb) {
+    free(fb->pixels);
+    free(fb->columns);
+    free(fb->gradient);
+    memset(fb, 0, sizeof(*fb));
+}
+
+uint64_t FramebufferHash(const Framebuffer* fb) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    const unsigned char* bytes = (const unsigned char*)fb->pixels;
+    size_t count = (size_t)fb->width * fb->height * sizeof(uint32_t);
+    for (size_t i = 0; i < count; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+long FramebufferDiff(const Framebuffer* a, const Framebuffer* b) {
+    if (a->width != b->width || a->height != b->height) return -1;
+    long diff = 0;
+    size_t count = (size_t)a->width * a->height;
+    for (size_t i = 0; i < count; i++) diff += (a->pixels[i] != b->pixels[i]);
+    return diff;
+}
+
+bool FramebufferWritePPM(const Framebuffer* fb, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", fb->width, fb->height);
+    size_t count = (size_t)fb->width * fb->height;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = fb->pixels[i];
+        unsigned char rgb[3] = { p & 0xFF, (p >> 8) & 0xFF, (p >> 16) & 0xFF };
+        fwrite(rgb, 1, 3, f);
+    }
+    return fclose(f) == 0;
+}
+
+RayCamera RaycastCameraFor(const PlayerState* player) {
+    // Direction order is N, E, S, W and angle 0 looks east
+    return (RayCamera){ player->x + 0.5f, player->y + 0.5f, (player->facing - 1) * 1.57079632679f };
+}
+
+void RaycastRender(Framebuffer* fb, const GameMap* map, RayCamera camera, WorkPool* pool) {
+    RenderJob job;
+    job.fb = fb;
+    job.map = map;
+    job.cam = camera;
+    job.dirX = cosf(camera.angle);
+    job.dirY = sinf(camera.angle);
+    job.planeX = -job.dirY * RAYCAST_FOV_PLANE;
+    job.planeY = job.dirX * RAYCAST_FOV_PLANE;
+    job.invDet = 1.0f / (job.planeX * job.dirY - job.dirX * job.planeY);
+    atomic_init(&job.nextColumn, 0);
+
+    if (pool) {
+        PoolRun(pool, CastJob, &job);
+    } else {
+        CastJob(&job, 0);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include "types.h"
+#include "workpool.h"
+
+// CPU grid raycaster for the first-person view. Tiles that IsValidMove
+// rejects are walls; unclaimed points stand on the floor as markers. It only
+// reads the map (never generates chunks), so it can run on worker threads
+// while the main thread waits, and it draws nothing through raylib: the
+// result is a plain pixel buffer that headless tools can hash and compare.
+
+#define RAYCAST_MAX_DEPTH 48      // Tiles a ray travels before fading out
+#define RAYCAST_FOV_PLANE 0.66f   // Camera plane half-width, ~66 degree FOV
+
+// RGBA8 pixels in memory order R, G, B, A (PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+// on little-endian machines). Ceiling pixels are fully transparent so the
+// level's background image shows through as sky.
+typedef struct Framebuffer {
+    int width, height;
+    uint32_t* pixels;     // Row-major, width * height; uploaded and compared
+    uint32_t* columns;    // Column-major scratch, a column contiguous; each band of
+                          // columns is copied into pixels as soon as it is cast
+    uint32_t* gradient;   // Ceiling and floor colour of every row
+} Framebuffer;
+
+// Eye position in tiles (tile centres at +0.5) and view angle in radians,
+// 0 looking east, growing clockwise on screen (towards south)
+typedef struct RayCamera {
+    float x, y;
+    float angle;
+} RayCamera;
+
+bool FramebufferInit(Framebuffer* fb, int width, int height);
+void FramebufferFree(Framebuffer* fb);
+
+// FNV-1a over the pixels, for golden-image checks
+uint64_t FramebufferHash(const Framebuffer* fb);
+
+// Number of pixels that differ (sizes must match, else -1)
+long FramebufferDiff(const Framebuffer* a, const Framebuffer* b);
+
+// Writes the pixels as a binary PPM (alpha dropped) for eyeballing a diff
+bool FramebufferWritePPM(const Framebuffer* fb, const char* path);
+
+// Camera standing in the middle of the player's tile, looking along facing
+RayCamera RaycastCameraFor(const PlayerState* player);
+
+// Renders one frame. Columns are split across the pool's workers (NULL runs
+// on the calling thread); the image is the same for any worker count.
+void RaycastRender(Framebuffer* fb, const GameMap* map, RayCamera camera, WorkPool* pool);
+
+#endif // RAYCAST_H
@@ -1,9 +1,58 @@
 #include "renderer.h"
 #include "resources.h" // Needs this to get the background images
+#include "input.h"
+#include "profiler.h"
+#include "gamemap.h"
+#include "raycast.h"
+#include "minimap.h"
+#include "levelgen.h"
 #include <stdio.h>
+#include <string.h>
 
-bool GuiButton(Button btn) {
-    Vector2 mousePoint = GetMousePosition();
+// A text box rendered once into a texture and blitted every frame.
+// The texture is SCR_WIDTH wide and exactly one box tall; only the
+// left `width` pixels are in use for the current text.
+typedef struct RetainedLabel {
+    RenderTexture2D target;
+    int width;
+    int fontSize;
+    bool valid;
+    char text[128];
+} RetainedLabel;
+
+// HUD values the label was last built from
+typedef struct HudKey {
+    int level, x, y, facing, score;
+    int remaining, total;
+} HudKey;
+
+// Full-screen snapshot of a dimmed level for overlay scenes. It remembers
+// which background texture it was built from, so a texture that streams in
+// while the overlay is up still replaces the placeholder.
+typedef struct FrozenBackdrop {
+    RenderTexture2D target;
+    bool loaded;
+    bool valid;
+    int level;
+    unsigned int textureId;
+} FrozenBackdrop;
+
+// First-person view: rendered on the CPU into frame, uploaded into texture
+typedef struct LevelViewTarget {
+    Framebuffer frame;
+    Texture2D texture;
+    WorkPool* pool;
+    bool loaded;
+} LevelViewTarget;
+
+static RetainedLabel hudLabel = { 0 };
+static RetainedLabel progressLabel = { 0 };
+static HudKey hudKey = { -1, -1, -1, -1, -1, -1, -1 };
+static FrozenBackdrop backdrop = { 0 };
+static LevelViewTarget view = { 0 };
+
+void DrawGuiButton(Button btn) {
+    Vector2 mousePoint = GetInputMousePosition();
     bool isHover = CheckCollisionPointRec(mousePoint, btn.rect);
     
     DrawRectangleRec(btn.rect, isHover ? LIGHTGRAY : btn.color);
@@ -13,8 +62,6 @@ bool GuiButton(Button btn) {
                      btn.rect.x + btn.rect.width/2, 
                      btn.rect.y + btn.rect.height/2 - 15, // -15 is half of font size 30
                      30, BLACK);
-    
-    return (isHover && IsMouseButtonReleased(MOUSE_BUTTON_LEFT));
 }
 
 void DrawCenteredText(const char* text, int centerX, int y, int fontSize, Color color) {
@@ -22,27 +69,229 @@ void DrawCenteredText(const char* text, int centerX, int y, int fontSize, Color
     DrawText(text, centerX - textWidth/2, y, fontSize, color);
 }
 
-void DrawLevelView(Scene* scene) {
-    // 1. Get the background texture from Resources
-    Texture2D tex = GetLevelTexture(scene->type);
-    
-    // 2. Draw it scaled to screen
+static void DrawLevelBackground(Texture2D tex) {
     Rectangle sourceRec = { 0.0f, 0.0f, (float)tex.width, (float)tex.height };
     Rectangle destRec = { 0.0f, 0.0f, (float)SCR_WIDTH, (float)SCR_HEIGHT };
     DrawTexturePro(tex, sourceRec, destRec, (Vector2){0,0}, 0.0f, WHITE);
 }
 
+static bool LoadLevelViewTarget(void) {
+    if (!FramebufferInit(&view.frame, SCR_WIDTH, SCR_HEIGHT)) return false;
+    Image image = { view.frame.pixels, SCR_WIDTH, SCR_HEIGHT, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    view.texture = LoadTextureFromImage(image);
+    view.pool = PoolCreate(GetGenerationThreadCount());
+    view.loaded = true;
+    return true;
+}
+
+// Eye between the previous and current tick, turning the short way round
+static RayCamera InterpolatedCamera(const Scene* scene) {
+    Vector2 pos = GetInterpolatedPosition(scene);
+    RayCamera cam = RaycastCameraFor(&scene->player);
+    int turn = (scene->player.facing - scene->prevPlayer.facing + 4) % 4;
+    float delta = (turn == 3) ? -1.0f : (float)turn;
+    cam.x = pos.x + 0.5f;
+    cam.y = pos.y + 0.5f;
+    cam.angle -= delta * 1.57079632679f * (1.0f - scene->interpolation);
+    return cam;
+}
+
+void DrawLevelView(Scene* scene) {
+    // The level image is the sky; the raycast view's ceiling is transparent
+    DrawLevelBackground(GetLevelTexture(scene->level));
+    if (!scene->map || (!view.loaded && !LoadLevelViewTarget())) return;
+
+    PROFILE_BEGIN("Raycast");
+    RaycastRender(&view.frame, scene->map, InterpolatedCamera(scene), view.pool);
+    PROFILE_END();
+    PROFILE_BEGIN("ViewUpload");
+    UpdateTexture(view.texture, view.frame.pixels);
+    PROFILE_END();
+    DrawTexture(view.texture, 0, 0, WHITE);
+}
+
+Vector2 GetInterpolatedPosition(const Scene* scene) {
+    float t = scene->interpolation;
+    return (Vector2){
+        scene->prevPlayer.x + (scene->player.x - scene->prevPlayer.x) * t,
+        scene->prevPlayer.y + (scene->player.y - scene->prevPlayer.y) * t
+    };
+}
+
+void UpdateFrozenBackdrop(int level) {
+    Texture2D tex = GetLevelTexture(level);
+    if (backdrop.valid && backdrop.level == level && backdrop.textureId == tex.id) return;
+
+    if (!backdrop.loaded) {
+        backdrop.target = LoadRenderTexture(SCR_WIDTH, SCR_HEIGHT);
+        backdrop.loaded = true;
+    }
+    BeginTextureMode(backdrop.target);
+    ClearBackground(BLACK);
+    DrawLevelBackground(tex);
+    // The last first-person frame is the one the overlay opened over
+    if (view.loaded) DrawTexture(view.texture, 0, 0, WHITE);
+    DrawRectangle(0, 0, SCR_WIDTH, SCR_HEIGHT, Fade(BLACK, 0.6f));
+    EndTextureMode();
+
+    backdrop.valid = true;
+    backdrop.level = level;
+    backdrop.textureId = tex.id;
+}
+
+void DrawFrozenBackdrop(void) {
+    if (!backdrop.valid) return;
+    Rectangle source = { 0, 0, (float)SCR_WIDTH, -(float)SCR_HEIGHT };
+    DrawTextureRec(backdrop.target.texture, source, (Vector2){ 0, 0 }, WHITE);
+}
+
+void InvalidateFrozenBackdrop(void) {
+    backdrop.valid = false;
+}
+
+int FormatHUDText(char* buf, int size, const Scene* scene, int score) {
+    const char* dirStrs[] = {"North", "East", "South", "West"};
+    return snprintf(buf, size, "Lvl: %d | X: %d Y: %d | Facing: %s | Score: %d",
+                    scene->level, scene->player.x, scene->player.y, dirStrs[scene->player.facing], score);
+}
+
+int FormatProgressText(char* buf, int size, const Scene* scene) {
+    int remaining = scene->map ? MapCountPoints(scene->map, POINTS_REMAINING) : 0;
+    int total = scene->map ? MapCountPoints(scene->map, POINTS_ALL) : 0;
+    return snprintf(buf, size, "Left: %d/%d", remaining, total);
+}
+
+// Re-renders the label only if its text changed
+static void UpdateRetainedLabel(RetainedLabel* label, const char* text, int fontSize) {
+    if (label->valid && label->fontSize == fontSize && strcmp(label->text, text) == 0) return;
+
+    int boxHeight = fontSize + 10;
+    if (!label->valid || label->fontSize != fontSize) {
+        if (label->valid) UnloadRenderTexture(label->target);
+        label->target = LoadRenderTexture(SCR_WIDTH, boxHeight);
+    }
+    strncpy(label->text, text, sizeof(label->text) - 1);
+    label->text[sizeof(label->text) - 1] = '\0';
+    label->fontSize = fontSize;
+    label->width = MeasureText(label->text, fontSize) + 40;
+    if (label->width > SCR_WIDTH) label->width = SCR_WIDTH;
+    label->valid = true;
+
+    // Clearing writes the translucent backing straight into the texture, so it
+    // isn't blended twice; the opaque text on top keeps full alpha
+    BeginTextureMode(label->target);
+    ClearBackground(Fade(BLACK, 0.6f));
+    DrawText(label->text, 20, 5, fontSize, RAYWHITE);
+    EndTextureMode();
+}
+
+static void DrawRetainedLabel(const RetainedLabel* label, int centerX, int y) {
+    // Render textures are stored bottom-up, hence the negative source height
+    Rectangle source = { 0, 0, (float)label->width, -(float)label->target.texture.height };
+    Vector2 position = { (float)(centerX - label->width / 2), (float)y };
+    DrawTextureRec(label->target.texture, source, position, WHITE);
+}
+
 void DrawHUD(Scene* scene, int score) {
-    char coordText[100];
-    char* dirStrs[] = {"North", "East", "South", "West"};
-    sprintf(coordText, "Lvl: %d | X: %d Y: %d | Facing: %s | Score: %d", 
-            scene->type, scene->player.x, scene->player.y, dirStrs[scene->player.facing], score);
-
-    int fontSize = 40;
-    int textWidth = MeasureText(coordText, fontSize);
-    int drawX = (SCR_WIDTH / 2) - (textWidth / 2);
-    int drawY = 20;
-
-    DrawRectangle(drawX - 20, drawY - 5, textWidth + 40, fontSize + 10, Fade(BLACK, 0.6f));
-    DrawText(coordText, drawX, drawY, fontSize, RAYWHITE);
+    HudKey key = { scene->level, scene->player.x, scene->player.y, scene->player.facing, score,
+                   scene->map ? MapCountPoints(scene->map, POINTS_REMAINING) : 0,
+                   scene->map ? MapCountPoints(scene->map, POINTS_ALL) : 0 };
+
+    // String formatting and text measuring only happen when a value changed
+    if (memcmp(&key, &hudKey, sizeof(key)) != 0) {
+        char coordText[128];
+        FormatHUDText(coordText, sizeof(coordText), scene, score);
+        UpdateRetainedLabel(&hudLabel, coordText, 40);
+        // Point counts sit on their own line so the first one fits the screen
+        if (key.remaining != hudKey.remaining || key.total != hudKey.total) {
+            FormatProgressText(coordText, sizeof(coordText), scene);
+            UpdateRetainedLabel(&progressLabel, coordText, 30);
+        }
+        hudKey = key;
+    }
+    DrawRetainedLabel(&hudLabel, SCR_WIDTH / 2, 15);
+    DrawRetainedLabel(&progressLabel, SCR_WIDTH / 2, 15 + hudLabel.fontSize + 15);
+}
+
+void DrawHintArrow(const Scene* scene, Direction toward, int steps, bool autoWalk) {
+    // 0 ahead, 1 right, 2 behind, 3 left; the arrow is drawn pointing up and rotated
+    int turn = (toward - scene->player.facing + 4) % 4;
+    static const float axisX[4] = { 0, 1, 0, -1 };
+    static const float axisY[4] = { -1, 0, 1, 0 };
+    float ax = axisX[turn], ay = axisY[turn];
+    Vector2 c = { SCR_WIDTH / 2.0f, SCR_HEIGHT - 90.0f };
+    const float len = 28, half = 18;
+
+    Vector2 tip = { c.x + ax * len, c.y + ay * len };
+    Vector2 left = { c.x - ax * len * 0.5f + ay * half, c.y - ay * len * 0.5f - ax * half };
+    Vector2 right = { c.x - ax * len * 0.5f - ay * half, c.y - ay * len * 0.5f + ax * half };
+    Color color = autoWalk ? GOLD : Fade(RAYWHITE, 0.85f);
+    // Tip, then the back corners counter-clockwise, as raylib wants
+    DrawTriangle(tip, left, right, color);
+
+    char label[32];
+    snprintf(label, sizeof(label), autoWalk ? "%d (auto)" : "%d", steps);
+    DrawCenteredText(label, (int)c.x, (int)c.y + 36, 20, color);
+}
+
+void DrawProfilerOverlay(void) {
+    ProfileStats stats;
+    if (!ProfileGetStats(&stats)) return;
+
+    const int width = 260, lineHeight = 18;
+    const int histHeight = 60;
+    int height = 10 + (3 + stats.phaseCount) * lineHeight + histHeight + 10;
+    int x = SCR_WIDTH - width - 10, y = 10;
+    DrawRectangle(x, y, width, height, Fade(BLACK, 0.75f));
+
+    char line[96];
+    int ty = y + 8;
+    snprintf(line, sizeof(line), "Frame p50 %.2f  p99 %.2f ms", stats.p50, stats.p99);
+    DrawText(line, x + 8, ty, 16, RAYWHITE);
+    ty += lineHeight;
+    snprintf(line, sizeof(line), "Max %.2f ms over %d frames", stats.max, stats.frames);
+    DrawText(line, x + 8, ty, 16, RAYWHITE);
+    ty += lineHeight;
+    if (stats.latencySamples > 0) {
+        snprintf(line, sizeof(line), "Input p50 %.1f  p99 %.1f ms", stats.latencyP50, stats.latencyP99);
+    } else {
+        snprintf(line, sizeof(line), "Input latency: no presses yet");
+    }
+    DrawText(line, x + 8, ty, 16, RAYWHITE);
+    ty += lineHeight;
+    for (int i = 0; i < stats.phaseCount; i++) {
+        snprintf(line, sizeof(line), "  %-14s %.2f ms", stats.phases[i].name, stats.phases[i].ms);
+        DrawText(line, x + 8, ty, 16, LIGHTGRAY);
+        ty += lineHeight;
+    }
+
+    // One bar per 2 ms bucket, scaled to the fullest bucket; the last bar is 32 ms and up
+    int peak = 1;
+    for (int b = 0; b < PROFILE_HIST_BUCKETS; b++) {
+        if (stats.histogram[b] > peak) peak = stats.histogram[b];
+    }
+    int barWidth = (width - 16) / PROFILE_HIST_BUCKETS;
+    int baseY = ty + histHeight;
+    for (int b = 0; b < PROFILE_HIST_BUCKETS; b++) {
+        int h = stats.histogram[b] * histHeight / peak;
+        Color c = (b * PROFILE_HIST_BUCKET_MS < 16.7) ? GREEN : (b * PROFILE_HIST_BUCKET_MS < 33.3 ? YELLOW : RED);
+        DrawRectangle(x + 8 + b * barWidth, baseY - h, barWidth - 1, h, c);
+    }
+}
+
+void UnloadRendererCache(void) {
+    if (hudLabel.valid) UnloadRenderTexture(hudLabel.target);
+    hudLabel.valid = false;
+    if (progressLabel.valid) UnloadRenderTexture(progressLabel.target);
+    progressLabel.valid = false;
+    hudKey = (HudKey){ -1, -1, -1, -1, -1, -1, -1 };
+    if (backdrop.loaded) UnloadRenderTexture(backdrop.target);
+    backdrop = (FrozenBackdrop){ 0 };
+    if (view.loaded) {
+        UnloadTexture(view.texture);
+        FramebufferFree(&view.frame);
+        PoolDestroy(view.pool);
+    }
+    view = (LevelViewTarget){ 0 };
+    UnloadMinimap();
 }
\ No newline at end of file
@@ -3,15 +3,49 @@
 
 #include "types.h"
 
-// Draws the immediate-mode UI button
-bool GuiButton(Button btn);
+// Draws a UI button, highlighted while hovered (clicks: GuiButtonPressed in input.h)
+void DrawGuiButton(Button btn);
 
-// Draws the main 3D-style view
+// Draws the first-person view: the level image as sky, with the map
+// raycast on the CPU over it (see raycast.h) and uploaded as one texture
 void DrawLevelView(Scene* scene);
 
-// Draws the HUD (text, score, etc.)
+// Player position between the previous and current tick, for smooth drawing
+// at render rates above the tick rate
+Vector2 GetInterpolatedPosition(const Scene* scene);
+
+// Renders a level's view, dimmed, into a cached screen-sized texture for
+// overlay scenes. Redraws only after InvalidateFrozenBackdrop() or when the
+// level's background texture changed (e.g. it finished streaming in).
+void UpdateFrozenBackdrop(int level);
+
+// Draws the cached backdrop over the whole screen
+void DrawFrozenBackdrop(void);
+
+// Marks the backdrop stale (Call when an overlay opens over a changed level)
+void InvalidateFrozenBackdrop(void);
+
+// Writes the HUD line (level, position, facing, score) into buf
+int FormatHUDText(char* buf, int size, const Scene* scene, int score);
+
+// Writes the HUD's second line (points left of the generated total) into buf
+int FormatProgressText(char* buf, int size, const Scene* scene);
+
+// Draws the HUD (text, score, etc.) from cached textures, each only
+// re-rendered when level, position, facing, score or point counts change
 void DrawHUD(Scene* scene, int score);
 
+// Draws frame-time percentiles, last frame's phases and a histogram of the
+// recent frame times in the top-right corner (nothing if profiling is off)
+void DrawProfilerOverlay(void);
+
+// Arrow at the bottom of the screen pointing (relative to the player's
+// facing) along the shortest path to the nearest point, with its distance
+void DrawHintArrow(const Scene* scene, Direction toward, int steps, bool autoWalk);
+
+// Releases cached render textures, the minimap's included (Call once at exit, before CloseWindow)
+void UnloadRendererCache(void);
+
 // Helper to center text
 void DrawCenteredText(const char* text, int centerX, int y, int fontSize, Color color);
 
@@ -0,0 +1,102 @@
+#include "replay.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ------------------------------------------------------------------
+// WRITER
+// ------------------------------------------------------------------
+bool ReplayOpenWriter(ReplayWriter* writer, const char* path, uint64_t seed) {
+    memset(writer, 0, sizeof(*writer));
+    writer->lastMouseX = -1;
+    writer->lastMouseY = -1;
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return false;
+
+    ReplayHeader header = { {'T', 'G', 'R', 'P'}, REPLAY_VERSION, seed, 0, 0 };
+    if (fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+        fclose(writer->file);
+        writer->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+void ReplayWriteFrame(ReplayWriter* writer, ReplayFrame frame) {
+    if (!writer->file) return;
+
+    unsigned char flags = frame.input & ~REPLAY_MOUSE_MOVED;
+    bool moved = (frame.mouseX != writer->lastMouseX || frame.mouseY != writer->lastMouseY);
+    if (moved) flags |= REPLAY_MOUSE_MOVED;
+
+    fputc(flags, writer->file);
+    if (moved) {
+        int16_t pos[2] = { (int16_t)frame.mouseX, (int16_t)frame.mouseY };
+        fwrite(pos, sizeof(pos), 1, writer->file);
+        writer->lastMouseX = frame.mouseX;
+        writer->lastMouseY = frame.mouseY;
+    }
+    writer->frameCount++;
+}
+
+void ReplayCloseWriter(ReplayWriter* writer) {
+    if (!writer->file) return;
+    // Patch the frame count in; a crash before this leaves 0, which readers handle
+    if (fseek(writer->file, offsetof(ReplayHeader, frameCount), SEEK_SET) == 0) {
+        fwrite(&writer->frameCount, sizeof(writer->frameCount), 1, writer->file);
+    }
+    fclose(writer->file);
+    writer->file = NULL;
+}
+
+// ------------------------------------------------------------------
+// READER
+// ------------------------------------------------------------------
+bool ReplayOpenReader(ReplayReader* reader, const char* path) {
+    memset(reader, 0, sizeof(*reader));
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    ReplayHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, "TGRP", 4) != 0 || header.version != REPLAY_VERSION) {
+        fclose(file);
+        return false;
+    }
+    reader->seed = header.seed;
+
+    int capacity = header.frameCount ? (int)header.frameCount : 1024;
+    reader->frames = malloc(capacity * sizeof(ReplayFrame));
+    int mouseX = 0, mouseY = 0;
+    int c;
+    while (reader->frames && (c = fgetc(file)) != EOF) {
+        if (c & REPLAY_MOUSE_MOVED) {
+            int16_t pos[2];
+            if (fread(pos, sizeof(pos), 1, file) != 1) break; // Torn final frame
+            mouseX = pos[0];
+            mouseY = pos[1];
+        }
+        if (reader->frameCount == capacity) {
+            capacity *= 2;
+            ReplayFrame* grown = realloc(reader->frames, capacity * sizeof(ReplayFrame));
+            if (!grown) break;
+            reader->frames = grown;
+        }
+        reader->frames[reader->frameCount++] =
+            (ReplayFrame){ (InputFrame)(c & ~REPLAY_MOUSE_MOVED), mouseX, mouseY };
+    }
+    fclose(file);
+    return reader->frames != NULL;
+}
+
+bool ReplayReadFrame(ReplayReader* reader, ReplayFrame* frame) {
+    if (reader->cursor >= reader->frameCount) return false;
+    *frame = reader->frames[reader->cursor++];
+    return true;
+}
+
+void ReplayCloseReader(ReplayReader* reader) {
+    free(reader->frames);
+    memset(reader, 0, sizeof(*reader));
+}
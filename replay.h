@@ -0,0 +1,54 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include "types.h"
+
+// --------------------------------------------------------------------------------------
+// FILE FORMAT
+// --------------------------------------------------------------------------------------
+// ReplayHeader, then one entry per frame: a flags byte holding the InputFrame
+// bits, with REPLAY_MOUSE_MOVED set when an int16 x, y mouse position follows.
+// Idle frames cost one byte.
+#define REPLAY_VERSION 1
+#define REPLAY_MOUSE_MOVED 0x80
+
+_Static_assert(CMD_HIGHEST < REPLAY_MOUSE_MOVED, "InputCommand bits collide with REPLAY_MOUSE_MOVED");
+
+typedef struct ReplayHeader {
+    char magic[4];          // "TGRP"
+    uint32_t version;
+    uint64_t seed;          // Session seed the recording started from
+    uint32_t frameCount;    // Patched on close; 0 means read until end of file
+    uint32_t reserved;
+} ReplayHeader;
+
+// One frame of recorded input
+typedef struct ReplayFrame {
+    InputFrame input;
+    int mouseX, mouseY;
+} ReplayFrame;
+
+typedef struct ReplayWriter {
+    FILE* file;
+    uint32_t frameCount;
+    int lastMouseX, lastMouseY;
+} ReplayWriter;
+
+typedef struct ReplayReader {
+    ReplayFrame* frames;    // Fully decoded at open, so playback never touches disk
+    int frameCount;
+    int cursor;
+    uint64_t seed;
+} ReplayReader;
+
+bool ReplayOpenWriter(ReplayWriter* writer, const char* path, uint64_t seed);
+void ReplayWriteFrame(ReplayWriter* writer, ReplayFrame frame);
+void ReplayCloseWriter(ReplayWriter* writer);
+
+bool ReplayOpenReader(ReplayReader* reader, const char* path);
+// Next recorded frame; returns false once the recording is exhausted
+bool ReplayReadFrame(ReplayReader* reader, ReplayFrame* frame);
+void ReplayCloseReader(ReplayReader* reader);
+
+#endif // REPLAY_H
@@ -1,30 +1,244 @@
 #include "resources.h"
-#include <stdio.h>
+#include "profiler.h"
+#include "gamelog.h"
+#include "levelpack.h"
+#include <pthread.h>
+#include <string.h>
+
+#define ASSET_CACHE_SLOTS 16
+#define ASSET_WORKERS 2
+
+typedef enum {
+    ASSET_EMPTY = 0,
+    ASSET_QUEUED,       // Waiting for a worker
+    ASSET_DECODING,     // A worker owns it
+    ASSET_DECODED,      // Image ready, waiting for the main thread to upload
+    ASSET_READY,        // Texture on the GPU
+    ASSET_FAILED
+} AssetState;
+
+typedef struct AssetSlot {
+    const char* path;
+    AssetState state;
+    Image image;
+    Texture2D texture;
+    size_t bytes;
+    unsigned long lastUsed;   // Frame of last use, for LRU eviction
+    unsigned long requested;  // Request order, workers take the oldest first
+} AssetSlot;
 
 // Private storage for textures
 // static means they are only visible in this file
-static Texture2D levelTextures[5]; 
+static AssetSlot slots[ASSET_CACHE_SLOTS];
+static Texture2D placeholder;
+static unsigned long frameCounter = 1;
+static unsigned long requestCounter = 0;
+
+// Slot states are shared with the workers and guarded by cacheLock
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_t workers[ASSET_WORKERS];
+static int workerCount = 0;
+static bool stopWorkers = false;
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static AssetSlot* NextQueuedSlot(void) {
+    AssetSlot* oldest = NULL;
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        if (slots[i].state == ASSET_QUEUED && (!oldest || slots[i].requested < oldest->requested)) {
+            oldest = &slots[i];
+        }
+    }
+    return oldest;
+}
+
+// Decodes PNGs off the main thread; only the GPU upload stays on it
+static void* DecodeWorker(void* arg) {
+    pthread_mutex_lock(&cacheLock);
+    for (;;) {
+        AssetSlot* slot = NextQueuedSlot();
+        while (!slot && !stopWorkers) {
+            pthread_cond_wait(&workAvailable, &cacheLock);
+            slot = NextQueuedSlot();
+        }
+        if (stopWorkers) break;
+
+        slot->state = ASSET_DECODING;
+        const char* path = slot->path;
+        pthread_mutex_unlock(&cacheLock);
+
+        PROFILE_BEGIN("DecodeImage");
+        Image image = LoadImage(path);
+        PROFILE_END();
+
+        pthread_mutex_lock(&cacheLock);
+        slot->image = image;
+        slot->state = (image.data != NULL) ? ASSET_DECODED : ASSET_FAILED;
+        slot->bytes = (size_t)image.width * image.height * 4;
+    }
+    pthread_mutex_unlock(&cacheLock);
+    return NULL;
+}
+
+// Frees the least recently used slot that has nothing in flight: a texture
+// or a failed load not used this frame. Caller holds cacheLock, main thread only.
+static AssetSlot* EvictSlot(void) {
+    AssetSlot* victim = NULL;
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        AssetSlot* s = &slots[i];
+        if (s->state != ASSET_READY && s->state != ASSET_FAILED) continue;
+        if (s->lastUsed >= frameCounter) continue;
+        if (!victim || s->lastUsed < victim->lastUsed) victim = s;
+    }
+    if (!victim) return NULL;
+    if (victim->state == ASSET_READY) UnloadTexture(victim->texture);
+    memset(victim, 0, sizeof(*victim));
+    return victim;
+}
+
+// Finds the slot for a path, claiming a free one if needed and evicting the
+// least recently used one when none is. Caller holds cacheLock.
+static AssetSlot* FindSlot(const char* path, bool create) {
+    AssetSlot* unused = NULL;
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        if (slots[i].path == path) return &slots[i];
+        if (!unused && slots[i].state == ASSET_EMPTY && !slots[i].path) unused = &slots[i];
+    }
+    if (!create) return NULL;
+    if (!unused) unused = EvictSlot();
+    if (!unused) return NULL;
+    unused->path = path;
+    return unused;
+}
+
+static void RequestSlot(AssetSlot* slot) {
+    if (slot->state != ASSET_EMPTY) return;
+    slot->state = ASSET_QUEUED;
+    slot->requested = ++requestCounter;
+    pthread_cond_signal(&workAvailable);
+}
+
+// Drops least recently used textures until the cache fits the budget.
+// Anything used this frame is kept even if that means staying over.
+static void EnforceBudget(void) {
+    for (;;) {
+        size_t total = 0;
+        AssetSlot* victim = NULL;
+        for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+            AssetSlot* s = &slots[i];
+            if (s->state != ASSET_READY && s->state != ASSET_DECODED) continue;
+            total += s->bytes;
+            if (s->state == ASSET_READY && s->lastUsed < frameCounter &&
+                (!victim || s->lastUsed < victim->lastUsed)) {
+                victim = s;
+            }
+        }
+        if (total <= TEXTURE_BUDGET_BYTES || !victim) return;
 
+        UnloadTexture(victim->texture);
+        memset(victim, 0, sizeof(*victim));
+    }
+}
+
+// Paths come from the level registry and stay put while it is loaded, so
+// slots can key on the pointer
+static const char* LevelAssetPath(int levelIndex) {
+    LevelDef def;
+    if (!GetLevelDef(levelIndex, &def)) return NULL;
+    return def.assetPath;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
 void LoadGameAssets(void) {
-    levelTextures[1] = LoadTexture("assets/bg_residence.png");
-    levelTextures[2] = LoadTexture("assets/bg_copse.png");
-    levelTextures[3] = LoadTexture("assets/bg_hospital.png");
-    levelTextures[4] = LoadTexture("assets/bg_dungeon.png");
-    
-    printf("Assets Loaded.\n");
+    PROFILE_BEGIN("LoadGameAssets");
+    Image blank = GenImageColor(2, 2, DARKGRAY);
+    placeholder = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+
+    stopWorkers = false;
+    for (int i = 0; i < ASSET_WORKERS; i++) {
+        if (pthread_create(&workers[workerCount], NULL, DecodeWorker, NULL) == 0) workerCount++;
+    }
+    GAMELOG_INFO("Asset streaming started (%d workers).", workerCount);
+    PROFILE_END();
 }
 
 void UnloadGameAssets(void) {
-    for(int i=1; i<=4; i++) {
-        UnloadTexture(levelTextures[i]);
+    pthread_mutex_lock(&cacheLock);
+    stopWorkers = true;
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock(&cacheLock);
+    for (int i = 0; i < workerCount; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    workerCount = 0;
+
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        if (slots[i].state == ASSET_READY) UnloadTexture(slots[i].texture);
+        if (slots[i].state == ASSET_DECODED) UnloadImage(slots[i].image);
+        memset(&slots[i], 0, sizeof(slots[i]));
     }
-    printf("Assets Unloaded.\n");
+    UnloadTexture(placeholder);
+    GAMELOG_INFO("Assets Unloaded.");
+}
+
+void UpdateAssetStreaming(void) {
+    frameCounter++;
+    PROFILE_BEGIN("UpdateAssetStreaming");
+
+    pthread_mutex_lock(&cacheLock);
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        AssetSlot* s = &slots[i];
+        if (s->state != ASSET_DECODED) continue;
+        // GPU upload has to happen on the thread that owns the GL context
+        s->texture = LoadTextureFromImage(s->image);
+        UnloadImage(s->image);
+        s->image = (Image){ 0 };
+        s->state = ASSET_READY;
+        s->lastUsed = frameCounter;
+    }
+    EnforceBudget();
+    pthread_mutex_unlock(&cacheLock);
+    PROFILE_END();
+}
+
+bool AssetStreamingIdle(void) {
+    bool idle = true;
+    pthread_mutex_lock(&cacheLock);
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        AssetState state = slots[i].state;
+        if (state == ASSET_QUEUED || state == ASSET_DECODING || state == ASSET_DECODED) idle = false;
+    }
+    pthread_mutex_unlock(&cacheLock);
+    return idle;
 }
 
 Texture2D GetLevelTexture(int levelIndex) {
-    if (levelIndex < 1 || levelIndex > 4) {
-        // Return a default "error" texture or the first one to prevent crash
-        return levelTextures[1]; 
+    const char* path = LevelAssetPath(levelIndex);
+    if (!path) return placeholder;
+
+    Texture2D result = placeholder;
+    pthread_mutex_lock(&cacheLock);
+    AssetSlot* slot = FindSlot(path, true);
+    if (slot) {
+        slot->lastUsed = frameCounter;
+        if (slot->state == ASSET_READY) result = slot->texture;
+        else RequestSlot(slot);
     }
-    return levelTextures[levelIndex];
-}
\ No newline at end of file
+    pthread_mutex_unlock(&cacheLock);
+    return result;
+}
+
+void PrefetchLevelTexture(int levelIndex) {
+    const char* path = LevelAssetPath(levelIndex);
+    if (!path) return;
+
+    pthread_mutex_lock(&cacheLock);
+    AssetSlot* slot = FindSlot(path, true);
+    if (slot) RequestSlot(slot);
+    pthread_mutex_unlock(&cacheLock);
+}
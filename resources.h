@@ -1,16 +1,34 @@
 #ifndef RESOURCES_H
 #define RESOURCES_H
 
+#include <stddef.h>
 #include "raylib.h"
 
-// Load all textures (Call once at startup)
+// Bytes of decoded images and textures kept around before the least
+// recently used ones are dropped
+#define TEXTURE_BUDGET_BYTES (64u * 1024u * 1024u)
+
+// Starts the decode workers and builds the placeholder (Call once at startup).
+// Nothing is decoded here; textures stream in when first requested.
 void LoadGameAssets(void);
 
-// Unload all textures (Call once at exit)
+// Stops the workers and unloads every texture (Call once at exit)
 void UnloadGameAssets(void);
 
-// Getters for specific assets
+// Uploads finished decodes to the GPU and enforces the budget.
+// Call once per frame on the main thread.
+void UpdateAssetStreaming(void);
+
+// True when no texture is waiting to be decoded or uploaded, so nothing on
+// screen is about to change from the placeholder
+bool AssetStreamingIdle(void);
+
+// Getters for specific assets. Returns a placeholder until the real
+// texture has been decoded and uploaded, and requests it if needed.
 Texture2D GetLevelTexture(int levelIndex);
+
+// Starts decoding a level's texture in the background without using it yet
+void PrefetchLevelTexture(int levelIndex);
 // You can add GetDaemonTexture(int id) here later
 
-#endif // RESOURCES_H
\ No newline at end of file
+#endif // RESOURCES_H
@@ -0,0 +1,135 @@
+#include "rewind.h"
+#include "gamemap.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static RewindKeyframe* KeyAt(const RewindBuffer* rw, int i) {
+    return &rw->keys[(rw->keyFirst + i) % rw->keyCapacity];
+}
+
+static void PushKey(RewindBuffer* rw, RewindKeyframe key) {
+    if (rw->keyCount == rw->keyCapacity) {
+        rw->keyFirst = (rw->keyFirst + 1) % rw->keyCapacity;
+        rw->keyCount--;
+    }
+    *KeyAt(rw, rw->keyCount++) = key;
+}
+
+// A keyframe is only usable while every delta after it is still in the ring.
+// There is always a newer one within an interval, so one survives.
+static void DropStaleKeys(RewindBuffer* rw) {
+    long oldest = rw->head - rw->capacity;
+    while (rw->keyCount > 1 && KeyAt(rw, 0)->seq < oldest) {
+        rw->keyFirst = (rw->keyFirst + 1) % rw->keyCapacity;
+        rw->keyCount--;
+    }
+}
+
+// Index of the newest keyframe at or before seq (the oldest must qualify)
+static int FindKey(const RewindBuffer* rw, long seq) {
+    int lo = 0, hi = rw->keyCount - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (KeyAt(rw, mid)->seq <= seq) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+bool RewindInit(RewindBuffer* rw, int capacity) {
+    memset(rw, 0, sizeof(*rw));
+    if (capacity < REWIND_KEYFRAME_INTERVAL) capacity = REWIND_KEYFRAME_INTERVAL;
+    rw->capacity = capacity;
+    rw->keyCapacity = capacity / REWIND_KEYFRAME_INTERVAL + 2;
+    rw->deltas = malloc((size_t)rw->capacity * sizeof(RewindDelta));
+    rw->keys = malloc((size_t)rw->keyCapacity * sizeof(RewindKeyframe));
+    if (!rw->deltas || !rw->keys) {
+        RewindFree(rw);
+        return false;
+    }
+    return true;
+}
+
+void RewindFree(RewindBuffer* rw) {
+    free(rw->deltas);
+    free(rw->keys);
+    memset(rw, 0, sizeof(*rw));
+}
+
+void RewindReset(RewindBuffer* rw, const GameMap* map, PlayerState player, int score) {
+    if (!rw->deltas) return;
+    rw->map = map;
+    rw->head = 0;
+    rw->keyFirst = 0;
+    rw->keyCount = 0;
+    rw->current = (RewindKeyframe){ 0, player, score, map ? map->claimLogCount : 0 };
+    PushKey(rw, rw->current);
+}
+
+void RewindRecord(RewindBuffer* rw, const GameMap* map, PlayerState player, int score) {
+    if (!rw->deltas) return;
+    RewindKeyframe* cur = &rw->current;
+    int claims = map->claimLogCount - cur->claimMark;
+    // Another map, or claims undone behind our back: the history no longer applies
+    if (map != rw->map || claims < 0) {
+        RewindReset(rw, map, player, score);
+        return;
+    }
+    int dx = player.x - cur->player.x;
+    int dy = player.y - cur->player.y;
+    int dScore = score - cur->score;
+    if (dx == 0 && dy == 0 && player.facing == cur->player.facing && claims == 0 && dScore == 0) return;
+
+    bool fits = dx >= INT8_MIN && dx <= INT8_MAX && dy >= INT8_MIN && dy <= INT8_MAX &&
+                claims <= UINT8_MAX && dScore >= INT16_MIN && dScore <= INT16_MAX;
+    rw->head++;
+    rw->deltas[rw->head % rw->capacity] = (RewindDelta){
+        (int8_t)dx, (int8_t)dy, (uint8_t)player.facing, (uint8_t)claims, (int16_t)dScore
+    };
+    *cur = (RewindKeyframe){ rw->head, player, score, map->claimLogCount };
+    if (!fits || rw->head % REWIND_KEYFRAME_INTERVAL == 0) PushKey(rw, *cur);
+    DropStaleKeys(rw);
+}
+
+int RewindAvailable(const RewindBuffer* rw) {
+    if (rw->keyCount == 0) return 0;
+    return (int)(rw->head - KeyAt(rw, 0)->seq);
+}
+
+int RewindSteps(RewindBuffer* rw, GameMap* map, int steps, PlayerState* player, int* score) {
+    int available = RewindAvailable(rw);
+    if (steps > available) steps = available;
+    if (steps <= 0 || map != rw->map) return 0;
+
+    // Nearest keyframe at or before the target, then forward through its deltas
+    long target = rw->head - steps;
+    int key = FindKey(rw, target);
+    RewindKeyframe state = *KeyAt(rw, key);
+    for (long seq = state.seq + 1; seq <= target; seq++) {
+        const RewindDelta* d = &rw->deltas[seq % rw->capacity];
+        state.player.x += d->dx;
+        state.player.y += d->dy;
+        state.player.facing = (Direction)d->facing;
+        state.claimMark += d->claims;
+        state.score += d->score;
+    }
+    state.seq = target;
+
+    MapRollback(map, state.claimMark);
+    rw->head = target;
+    rw->keyCount = key + 1;
+    rw->current = state;
+    *player = state.player;
+    *score = state.score;
+    return steps;
+}
+
+size_t RewindBytes(const RewindBuffer* rw) {
+    return (size_t)rw->capacity * sizeof(RewindDelta) + (size_t)rw->keyCapacity * sizeof(RewindKeyframe);
+}
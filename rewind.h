@@ -0,0 +1,65 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stddef.h>
+#include "types.h"
+
+// Step-by-step undo for one level. Every tick that changed something is kept
+// as a small delta (position, facing, claims, score) in a fixed ring, with a
+// full keyframe every REWIND_KEYFRAME_INTERVAL deltas. Claims themselves are
+// not copied: a keyframe holds the map's claim log length and rewinding rolls
+// the log back to it, so memory stays fixed however big the map gets.
+
+#define REWIND_CAPACITY 8192           // Steps kept before the oldest are dropped
+#define REWIND_KEYFRAME_INTERVAL 64    // Deltas between keyframes
+
+// Change made by one tick. Steps that don't fit (a jump, a burst of claims)
+// are stored as keyframes instead.
+typedef struct RewindDelta {
+    int8_t dx, dy;
+    uint8_t facing;       // Facing after the tick
+    uint8_t claims;       // Claim log entries added
+    int16_t score;        // Score change
+} RewindDelta;
+
+// Full state after step seq
+typedef struct RewindKeyframe {
+    long seq;
+    PlayerState player;
+    int score;
+    int claimMark;        // Claim log length
+} RewindKeyframe;
+
+typedef struct RewindBuffer {
+    const GameMap* map;   // Map the history belongs to
+    RewindDelta* deltas;  // Step seq lives at seq % capacity
+    int capacity;
+    RewindKeyframe* keys; // Ring, oldest at keyFirst, ordered by seq
+    int keyCapacity, keyFirst, keyCount;
+    long head;            // Steps recorded so far (seq of the newest)
+    RewindKeyframe current; // State after head, to diff the next tick against
+} RewindBuffer;
+
+// Allocates the rings (capacity steps). False if out of memory.
+bool RewindInit(RewindBuffer* rw, int capacity);
+void RewindFree(RewindBuffer* rw);
+
+// Drops the history and starts a new one from this state (e.g. entering a level)
+void RewindReset(RewindBuffer* rw, const GameMap* map, PlayerState player, int score);
+
+// Call after every tick. Ticks that changed nothing aren't stored. O(1).
+void RewindRecord(RewindBuffer* rw, const GameMap* map, PlayerState player, int score);
+
+// Steps that can currently be undone
+int RewindAvailable(const RewindBuffer* rw);
+
+// Undoes the last steps (clamped to what is available): rolls the map's claims
+// back and writes the player and score of that point. The undone steps are
+// forgotten. Costs a binary search, at most one keyframe interval of deltas
+// and the claims undone. Returns the number of steps undone.
+int RewindSteps(RewindBuffer* rw, GameMap* map, int steps, PlayerState* player, int* score);
+
+// Heap bytes held, fixed by the capacity
+size_t RewindBytes(const RewindBuffer* rw);
+
+#endif // REWIND_H
@@ -0,0 +1,39 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// SplitMix64 generator. Streams are split off a parent seed by hashing a
+// stream id into it, so each level/chunk draws from its own sequence and
+// never depends on what order (or on which thread) the others ran.
+typedef struct Rng {
+    uint64_t state;
+} Rng;
+
+// Strong 64-bit finalizer, also usable as a hash
+static inline uint64_t RngMix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Seed of child stream `stream` under `seed`
+static inline uint64_t RngDerive(uint64_t seed, uint64_t stream) {
+    return RngMix(seed ^ RngMix(stream + 0x9E3779B97F4A7C15ull));
+}
+
+static inline Rng RngStream(uint64_t seed, uint64_t stream) {
+    return (Rng){ RngDerive(seed, stream) };
+}
+
+static inline uint64_t RngNext(Rng* rng) {
+    rng->state += 0x9E3779B97F4A7C15ull;
+    return RngMix(rng->state);
+}
+
+// Uniform value in [0, bound), bound > 0
+static inline uint32_t RngRange(Rng* rng, uint32_t bound) {
+    return (uint32_t)(((RngNext(rng) >> 32) * bound) >> 32);
+}
+
+#endif // RNG_H
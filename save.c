@@ -0,0 +1,329 @@
+#define _POSIX_C_SOURCE 200809L
+#include "save.h"
+#include "gamemap.h"
+#include "rng.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static uint32_t RecordCheck(const JournalRecord* r) {
+    uint64_t key = ((uint64_t)r->type << 56) | ((uint64_t)r->facing << 48) |
+                   ((uint64_t)r->level << 32) | (uint32_t)r->x;
+    uint64_t h = RngMix(key ^ RngMix((uint32_t)r->y));
+    return (uint32_t)h | 1u; // Never zero, so a zero-filled tail is always rejected
+}
+
+static bool RecordValid(const JournalRecord* r) {
+    return (r->type == JOURNAL_CLAIM || r->type == JOURNAL_MOVE) && r->check == RecordCheck(r);
+}
+
+static bool WriteAll(int fd, const void* buf, size_t size) {
+    const unsigned char* p = buf;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static uint64_t NewSnapshotId(void) {
+    static uint64_t counter = 0;
+    uint64_t id = RngMix(((uint64_t)time(NULL) << 20) ^ ++counter);
+    return id ? id : 1;
+}
+
+static bool WriteJournalHeader(int fd, uint64_t snapshotId) {
+    JournalHeader header = { {'T', 'G', 'J', 'R'}, SAVE_VERSION, snapshotId };
+    if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0) return false;
+    return WriteAll(fd, &header, sizeof(header));
+}
+
+// ------------------------------------------------------------------
+// SNAPSHOT
+// ------------------------------------------------------------------
+bool SaveMapFile(SaveFile* save, const char* path) {
+    memset(save, 0, sizeof(*save));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SaveHeader)) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    save->data = data;
+    save->size = (size_t)st.st_size;
+    save->header = (const SaveHeader*)save->data;
+    save->levels = (const SaveLevel*)(save->data + sizeof(SaveHeader));
+
+    // Validate every offset once so callers can use the mapping blindly
+    const SaveHeader* h = save->header;
+    bool ok = memcmp(h->magic, "TGSV", 4) == 0 && h->version == SAVE_VERSION &&
+              sizeof(SaveHeader) + (size_t)h->levelCount * sizeof(SaveLevel) <= save->size;
+    for (uint32_t i = 0; ok && i < h->levelCount; i++) {
+        const SaveLevel* l = &save->levels[i];
+        ok = l->claimsOffset % sizeof(uint32_t) == 0 &&
+             (size_t)l->claimsOffset + (size_t)l->claimCount * sizeof(uint32_t) <= save->size;
+    }
+    if (!ok) {
+        SaveUnmapFile(save);
+        return false;
+    }
+    return true;
+}
+
+void SaveUnmapFile(SaveFile* save) {
+    if (save->data) munmap((void*)save->data, save->size);
+    memset(save, 0, sizeof(*save));
+}
+
+const uint32_t* SaveLevelClaims(const SaveFile* save, int i) {
+    return (const uint32_t*)(save->data + save->levels[i].claimsOffset);
+}
+
+bool SaveCaptureSnapshot(SaveImage* image, const SaveContents* contents) {
+    memset(image, 0, sizeof(*image));
+    // Only levels with claims get an entry, so the file grows with progress
+    // rather than with the size of the pack
+    int entries = 0;
+    size_t claimBytes = 0;
+    for (int i = 0; i < contents->levelCount; i++) {
+        int count = contents->maps[i] ? MapCountPoints(contents->maps[i], POINTS_CLAIMED) : 0;
+        if (count == 0) continue;
+        entries++;
+        claimBytes += (size_t)count * sizeof(uint32_t);
+    }
+    size_t offset = sizeof(SaveHeader) + (size_t)entries * sizeof(SaveLevel);
+    size_t size = offset + claimBytes;
+    unsigned char* data = calloc(1, size);
+    if (!data) return false;
+
+    SaveHeader* header = (SaveHeader*)data;
+    memcpy(header->magic, "TGSV", 4);
+    header->version = SAVE_VERSION;
+    header->snapshotId = NewSnapshotId();
+    header->sessionSeed = contents->sessionSeed;
+    header->score = contents->score;
+    header->lastLevel = contents->lastLevel;
+    header->playerX = contents->player.x;
+    header->playerY = contents->player.y;
+    header->playerFacing = contents->player.facing;
+    header->levelCount = (uint32_t)entries;
+
+    SaveLevel* level = (SaveLevel*)(data + sizeof(SaveHeader));
+    TilePos* claims = NULL;
+    int claimsCapacity = 0;
+    bool ok = true;
+    for (int i = 0; ok && i < contents->levelCount; i++) {
+        GameMap* map = contents->maps[i];
+        int count = map ? MapCountPoints(map, POINTS_CLAIMED) : 0;
+        if (count == 0) continue;
+        level->level = i + 1;
+        level->width = map->width;
+        level->height = map->height;
+        level->seed = map->seed;
+        level->claimsOffset = (uint32_t)offset;
+
+        if (count > claimsCapacity) {
+            TilePos* grown = realloc(claims, (size_t)count * sizeof(TilePos));
+            ok = grown != NULL;
+            if (!ok) break;
+            claims = grown;
+            claimsCapacity = count;
+        }
+        ok = MapListPoints(map, POINTS_CLAIMED, claims, count) == count;
+        uint32_t* packed = (uint32_t*)(data + offset);
+        for (int c = 0; ok && c < count; c++) {
+            packed[c] = (uint32_t)claims[c].x | ((uint32_t)claims[c].y << 16);
+        }
+        level->claimCount = (uint32_t)count;
+        offset += (size_t)count * sizeof(uint32_t);
+        level++;
+    }
+    free(claims);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+
+    image->data = data;
+    image->size = size;
+    image->snapshotId = header->snapshotId;
+    return true;
+}
+
+void SaveFreeImage(SaveImage* image) {
+    free(image->data);
+    memset(image, 0, sizeof(*image));
+}
+
+bool SaveWriteImage(const char* path, const SaveImage* image) {
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && WriteAll(fd, image->data, image->size) && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+
+    if (!ok || rename(tmpPath, path) != 0) {
+        unlink(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+uint64_t SaveWriteSnapshot(const char* path, const SaveContents* contents) {
+    SaveImage image;
+    if (!SaveCaptureSnapshot(&image, contents)) return 0;
+    uint64_t id = SaveWriteImage(path, &image) ? image.snapshotId : 0;
+    SaveFreeImage(&image);
+    return id;
+}
+
+// ------------------------------------------------------------------
+// BACKGROUND WRITER
+// ------------------------------------------------------------------
+// fsync can take tens of milliseconds, so it stays off the main thread
+static void* SaveWriterThread(void* arg) {
+    SaveWriter* writer = arg;
+    writer->ok = SaveWriteImage(writer->path, &writer->image);
+    atomic_store_explicit(&writer->done, true, memory_order_release);
+    return NULL;
+}
+
+void SaveWriterStart(SaveWriter* writer, const char* path, SaveImage* image) {
+    snprintf(writer->path, sizeof(writer->path), "%s", path);
+    writer->image = *image;
+    memset(image, 0, sizeof(*image));
+    writer->busy = true;
+    atomic_store_explicit(&writer->done, false, memory_order_relaxed);
+    writer->threaded = pthread_create(&writer->thread, NULL, SaveWriterThread, writer) == 0;
+    if (!writer->threaded) SaveWriterThread(writer);
+}
+
+bool SaveWriterPoll(SaveWriter* writer, uint64_t* snapshotId) {
+    if (!writer->busy || !atomic_load_explicit(&writer->done, memory_order_acquire)) return false;
+    *snapshotId = SaveWriterWait(writer);
+    return true;
+}
+
+uint64_t SaveWriterWait(SaveWriter* writer) {
+    if (!writer->busy) return 0;
+    if (writer->threaded) pthread_join(writer->thread, NULL);
+    writer->busy = false;
+    writer->threaded = false;
+    uint64_t id = writer->ok ? writer->image.snapshotId : 0;
+    SaveFreeImage(&writer->image);
+    return id;
+}
+
+// ------------------------------------------------------------------
+// JOURNAL
+// ------------------------------------------------------------------
+int JournalReplay(const char* path, uint64_t snapshotId,
+                  void (*apply)(const JournalRecord* record, void* ctx), void* ctx) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(JournalHeader)) {
+        close(fd);
+        return 0;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return 0;
+
+    const JournalHeader* header = data;
+    int applied = 0;
+    if (memcmp(header->magic, "TGJR", 4) == 0 && header->version == SAVE_VERSION &&
+        header->snapshotId == snapshotId) {
+        const JournalRecord* records = (const JournalRecord*)((const unsigned char*)data + sizeof(JournalHeader));
+        size_t count = ((size_t)st.st_size - sizeof(JournalHeader)) / sizeof(JournalRecord);
+        // Stop at the first bad record: everything after a torn write is suspect
+        for (size_t i = 0; i < count && RecordValid(&records[i]); i++) {
+            apply(&records[i], ctx);
+            applied++;
+        }
+    }
+    munmap(data, (size_t)st.st_size);
+    return applied;
+}
+
+bool JournalOpen(SaveJournal* journal, const char* path, uint64_t snapshotId) {
+    journal->fd = open(path, O_RDWR | O_CREAT, 0644);
+    journal->snapshotId = snapshotId;
+    journal->records = 0;
+    if (journal->fd < 0) return false;
+
+    // Keep the intact prefix of a matching journal, start over otherwise
+    JournalHeader header;
+    bool matches = read(journal->fd, &header, sizeof(header)) == (ssize_t)sizeof(header) &&
+                   memcmp(header.magic, "TGJR", 4) == 0 && header.version == SAVE_VERSION &&
+                   header.snapshotId == snapshotId;
+    if (matches) {
+        JournalRecord record;
+        while (read(journal->fd, &record, sizeof(record)) == (ssize_t)sizeof(record) && RecordValid(&record)) {
+            journal->records++;
+        }
+        off_t end = (off_t)(sizeof(JournalHeader) + (size_t)journal->records * sizeof(JournalRecord));
+        matches = ftruncate(journal->fd, end) == 0 && lseek(journal->fd, end, SEEK_SET) == end;
+    }
+    if (!matches && !WriteJournalHeader(journal->fd, snapshotId)) {
+        JournalClose(journal);
+        return false;
+    }
+    return true;
+}
+
+void JournalClose(SaveJournal* journal) {
+    if (journal->fd >= 0) close(journal->fd);
+    journal->fd = -1;
+}
+
+void JournalAppend(SaveJournal* journal, JournalRecordType type, int level, int x, int y, int facing) {
+    if (journal->fd < 0) return;
+    JournalRecord record = { (uint8_t)type, (uint8_t)facing, (uint16_t)level, x, y, 0 };
+    record.check = RecordCheck(&record);
+    if (WriteAll(journal->fd, &record, sizeof(record))) journal->records++;
+}
+
+void JournalReset(SaveJournal* journal, uint64_t newSnapshotId) {
+    if (journal->fd < 0) return;
+    journal->snapshotId = newSnapshotId;
+    journal->records = 0;
+    if (!WriteJournalHeader(journal->fd, newSnapshotId)) JournalClose(journal);
+}
+
+void JournalRebase(SaveJournal* journal, uint64_t newSnapshotId, int keepFrom) {
+    if (journal->fd < 0) return;
+    int keep = journal->records - keepFrom;
+    if (keepFrom < 0 || keep <= 0) {
+        JournalReset(journal, newSnapshotId);
+        return;
+    }
+
+    // The tail is a few ticks of play at most, read back from the file itself
+    JournalRecord* tail = malloc((size_t)keep * sizeof(JournalRecord));
+    off_t from = (off_t)(sizeof(JournalHeader) + (size_t)keepFrom * sizeof(JournalRecord));
+    bool ok = tail && pread(journal->fd, tail, (size_t)keep * sizeof(JournalRecord), from) ==
+                      (ssize_t)((size_t)keep * sizeof(JournalRecord));
+    JournalReset(journal, newSnapshotId);
+    if (ok && journal->fd >= 0 && WriteAll(journal->fd, tail, (size_t)keep * sizeof(JournalRecord))) {
+        journal->records = keep;
+    }
+    free(tail);
+}
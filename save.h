@@ -0,0 +1,158 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "types.h"
+
+// --------------------------------------------------------------------------------------
+// ON-DISK FORMAT (native byte order, fixed-size records)
+// --------------------------------------------------------------------------------------
+// <base>.bin      SaveHeader, SaveLevel[levelCount], then each level's claims as
+//                 packed uint32_t (x | y << 16). Rewritten only on compaction.
+//                 Only levels with claims have an entry; any other level is
+//                 untouched and comes back from the registry.
+// <base>.journal  JournalHeader, then JournalRecords appended one per event.
+//                 Only applies to the snapshot whose id it carries.
+#define SAVE_VERSION 2
+#define SAVE_COMPACT_RECORDS 4096   // Journal length that triggers compaction
+
+typedef struct SaveLevel {
+    int32_t level;                  // Level number, 1-based
+    int32_t width, height;
+    uint32_t claimCount;
+    uint64_t seed;
+    uint32_t claimsOffset;          // Byte offset of this level's claims in the file
+    uint32_t reserved;
+} SaveLevel;
+
+typedef struct SaveHeader {
+    char magic[4];                  // "TGSV"
+    uint32_t version;
+    uint64_t snapshotId;
+    uint64_t sessionSeed;
+    int32_t score;
+    int32_t lastLevel;              // 0 when no level was in progress
+    int32_t playerX, playerY, playerFacing;
+    uint32_t levelCount;            // SaveLevel entries, not levels in the pack
+} SaveHeader;
+
+typedef enum {
+    JOURNAL_CLAIM = 1,
+    JOURNAL_MOVE = 2
+} JournalRecordType;
+
+typedef struct JournalHeader {
+    char magic[4];                  // "TGJR"
+    uint32_t version;
+    uint64_t snapshotId;
+} JournalHeader;
+
+typedef struct JournalRecord {
+    uint8_t type;
+    uint8_t facing;
+    uint16_t level;
+    int32_t x, y;
+    uint32_t check;                 // Detects a torn final record after a crash
+} JournalRecord;
+
+// --------------------------------------------------------------------------------------
+// SNAPSHOT
+// --------------------------------------------------------------------------------------
+// A snapshot mapped read-only into memory; fields are used in place.
+typedef struct SaveFile {
+    const unsigned char* data;
+    size_t size;
+    const SaveHeader* header;
+    const SaveLevel* levels;
+} SaveFile;
+
+// What a snapshot is written from
+typedef struct SaveContents {
+    uint64_t sessionSeed;
+    int score;
+    int lastLevel;
+    PlayerState player;
+    GameMap** maps;                 // levelCount entries, index 0 = level 1; NULL = never played.
+                                    // Maps without claims are left out of the snapshot.
+    int levelCount;
+} SaveContents;
+
+// Maps and validates a snapshot. Returns false if missing, truncated or foreign.
+bool SaveMapFile(SaveFile* save, const char* path);
+void SaveUnmapFile(SaveFile* save);
+
+// Packed claims of entry i (0-based) of save->levels
+const uint32_t* SaveLevelClaims(const SaveFile* save, int i);
+
+// A snapshot serialized into memory, so it can be written without the maps
+typedef struct SaveImage {
+    unsigned char* data;
+    size_t size;
+    uint64_t snapshotId;
+} SaveImage;
+
+// Serializes contents into image (Call on the thread that owns the maps).
+// Returns false if out of memory.
+bool SaveCaptureSnapshot(SaveImage* image, const SaveContents* contents);
+void SaveFreeImage(SaveImage* image);
+
+// Writes an image atomically (temp file, fsync, rename). Safe on any thread.
+bool SaveWriteImage(const char* path, const SaveImage* image);
+
+// Capture and write on the calling thread. Returns the snapshot id, 0 on failure.
+uint64_t SaveWriteSnapshot(const char* path, const SaveContents* contents);
+
+// Writes one image at a time on a background thread
+typedef struct SaveWriter {
+    pthread_t thread;
+    bool busy;                      // A write was started and not collected yet
+    bool threaded;                  // thread runs it and has to be joined
+    atomic_bool done;               // Set by the thread when the file is in place
+    bool ok;
+    char path[256];
+    SaveImage image;
+} SaveWriter;
+
+// Takes ownership of image and starts writing it. Writes right away if no
+// thread can be started. The writer must not be busy.
+void SaveWriterStart(SaveWriter* writer, const char* path, SaveImage* image);
+
+// True once the write started last has finished, reported once; *snapshotId
+// gets its id, or 0 if it failed. Never blocks.
+bool SaveWriterPoll(SaveWriter* writer, uint64_t* snapshotId);
+
+// Blocks until the write in flight is done. Returns its id, 0 on failure or if idle.
+uint64_t SaveWriterWait(SaveWriter* writer);
+
+// --------------------------------------------------------------------------------------
+// JOURNAL
+// --------------------------------------------------------------------------------------
+typedef struct SaveJournal {
+    int fd;
+    uint64_t snapshotId;
+    int records;
+} SaveJournal;
+
+// Calls apply for every intact record of the journal belonging to snapshotId.
+// Returns the number of records applied.
+int JournalReplay(const char* path, uint64_t snapshotId,
+                  void (*apply)(const JournalRecord* record, void* ctx), void* ctx);
+
+// Opens the journal for appending. A journal for another snapshot is reset,
+// a torn tail is cut off.
+bool JournalOpen(SaveJournal* journal, const char* path, uint64_t snapshotId);
+void JournalClose(SaveJournal* journal);
+
+// One small write per event
+void JournalAppend(SaveJournal* journal, JournalRecordType type, int level, int x, int y, int facing);
+
+// Empties the journal after its records were folded into snapshot newSnapshotId
+void JournalReset(SaveJournal* journal, uint64_t newSnapshotId);
+
+// Starts the journal over for snapshot newSnapshotId, keeping the records from
+// index keepFrom on: those appended after the snapshot was captured
+void JournalRebase(SaveJournal* journal, uint64_t newSnapshotId, int keepFrom);
+
+#endif // SAVE_H
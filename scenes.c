@@ -1,7 +1,20 @@
 #include "scenes.h"
 #include "renderer.h"
 #include "coremechanics.h"
+#include "gamemap.h"
+#include "levelgen.h"
+#include "rng.h"
+#include "save.h"
+#include "input.h"
+#include "resources.h"
+#include "profiler.h"
+#include "gamelog.h"
+#include "distfield.h"
+#include "minimap.h"
+#include "levelpack.h"
+#include "rewind.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 // ------------------------------------------------------------------
 // GLOBAL DATA STORAGE
@@ -9,11 +22,71 @@
 int globalScore = 0;
 bool gameShouldClose = false;
 
-static GameMap storedMaps[5];
-static PlayerState storedPlayerStates[5];
+#define LEVEL_PREGEN_CHUNKS 64  // Levels of up to this many chunks are generated up front
+
+static uint64_t sessionSeed = 0;
+// One slot per registry level (index = level number). Maps are created on
+// first entry, so levels that are never played cost a NULL pointer.
+static GameMap** levelMaps = NULL;
+static int levelMapCount = 0;
 static int lastActiveLevel = 1;
 
-static Scene activeScene;
+// Autosave: snapshot at <base>.bin plus an append-only <base>.journal
+static char savePath[256];
+static char journalPath[256];
+static SaveJournal journal = { -1, 0, 0 };
+static bool journalStale = false;     // Rewind undid claims the journal still holds
+static SaveWriter saveWriter = { 0 };
+static int compactedRecords = 0;      // Journal records the snapshot being written already has
+static bool compactPending = false;   // Another compaction was asked for during the write
+static bool hasContinue = false;      // A restored level is waiting in the menu
+static int continueLevel = 1;
+static PlayerState continuePlayer;
+
+// Scene pool: every scene object is set up once in InitSceneSystem and from
+// then on only pushed and popped, so a transition is a pointer move no matter
+// how much state a level owns. Overlays (pause) stack on the live level.
+#define SCENE_STACK_MAX 4
+static Scene menuScene;
+static Scene pauseScene;
+static Scene levelScenes[2];
+static Scene* liveLevel = &levelScenes[0];    // The level being played (or paused)
+static Scene* stagedLevel = &levelScenes[1];  // Next level, preloaded; map is NULL if none
+static Scene* sceneStack[SCENE_STACK_MAX];
+static int sceneDepth = 0;
+
+// What the frozen backdrop was last built from, so pausing again in the same
+// spot reuses it instead of re-rendering
+static struct {
+    const GameMap* map;
+    PlayerState player;
+    int claims, rollbackGen;
+} backdropState = { NULL, { 0, 0, DIR_NORTH }, -1, -1 };
+
+// Nearest-point guidance for the active level
+#define AUTO_WALK_INTERVAL 8          // Ticks between auto-walk commands
+static DistanceField hintField;
+static bool autoWalk = false;
+static int autoWalkTicks = 0;
+
+// Undo history of the live level; fixed size, reset on every level entry
+static RewindBuffer rewindHistory;
+
+// Menu layouts. Clicks are handled in Update, Draw only renders them,
+// so menus also work headless (e.g. replays without a window).
+// Level buttons are laid out a page at a time from the registry.
+#define LEVELS_PER_PAGE 4
+static int menuPage = 0;
+static char levelLabels[LEVELS_PER_PAGE][LEVEL_NAME_MAX + 24];
+static const Button btnPrevPage = { (Rectangle){320, 370, 60, 60}, "<", GRAY };
+static const Button btnNextPage = { (Rectangle){820, 370, 60, 60}, ">", GRAY };
+static char continueText[LEVEL_NAME_MAX + 16];
+static const Button btnContinue = { (Rectangle){400, 570, 400, 60}, continueText, LIGHTGRAY };
+static const Button btnResume = { (Rectangle){400, 250, 400, 60}, "RESUME", LIGHTGRAY };
+static const Button btnExit = { (Rectangle){400, 650, 400, 60}, "EXIT GAME", MAROON };
+#define MENU_MAX_BUTTONS (LEVELS_PER_PAGE + 4)
+static int menuHover = 0;             // Hovered button of the last menu tick (see HoveredButton)
+static int pauseHover = 0;
 
 // ------------------------------------------------------------------
 // INTERNAL FUNCTION PROTOTYPES
@@ -22,7 +95,9 @@ void InitMenuMain(void);
 void UpdateMenuMain(Scene* s); 
 void DrawMenuMain(Scene* s);
 
-void InitLevel(int levelNum, bool resetPosition);
+bool InitLevel(int levelNum);
+void ResumeLevel(void);
+void ContinueLevel(void);
 void UpdateLevel(Scene* s); 
 void DrawLevel(Scene* s);
 
@@ -30,39 +105,337 @@ void InitMenuPause(void);
 void UpdateMenuPause(Scene* s); 
 void DrawMenuPause(Scene* s);
 
+// ------------------------------------------------------------------
+// SCENE STACK
+// ------------------------------------------------------------------
+// Clears the stack down to a single base scene
+static void SetBaseScene(Scene* scene) {
+    sceneStack[0] = scene;
+    sceneDepth = 1;
+}
+
+static void PushScene(Scene* scene) {
+    if (sceneDepth < SCENE_STACK_MAX) sceneStack[sceneDepth++] = scene;
+}
+
+static void PopScene(void) {
+    if (sceneDepth > 1) sceneDepth--;
+}
+
+// Scene under an overlay, NULL for the bottom one
+static Scene* SceneBelow(const Scene* scene) {
+    for (int i = 1; i < sceneDepth; i++) {
+        if (sceneStack[i] == scene) return sceneStack[i - 1];
+    }
+    return NULL;
+}
+
+static bool LevelInProgress(void) {
+    return sceneDepth > 0 && sceneStack[0] == liveLevel;
+}
+
+static void InitScenePool(void) {
+    menuScene = (Scene){ .type = SCENE_MENU_MAIN, .Update = UpdateMenuMain, .Draw = DrawMenuMain };
+    pauseScene = (Scene){ .type = SCENE_MENU_PAUSE, .Update = UpdateMenuPause, .Draw = DrawMenuPause };
+    for (int i = 0; i < 2; i++) {
+        levelScenes[i] = (Scene){ .type = SCENE_LEVEL, .Update = UpdateLevel, .Draw = DrawLevel };
+    }
+    liveLevel = &levelScenes[0];
+    stagedLevel = &levelScenes[1];
+    SetBaseScene(&menuScene);
+}
+
+// ------------------------------------------------------------------
+// LEVEL MAPS
+// ------------------------------------------------------------------
+static uint64_t LevelSeed(const LevelDef* def) {
+    return RngDerive(sessionSeed, def->seedStream);
+}
+
+// Where the registry puts the player, DefaultSpawn if it doesn't say or
+// says a wall
+static PlayerState LevelSpawn(int levelNum, const GameMap* map) {
+    LevelDef def;
+    if (GetLevelDef(levelNum, &def) && def.spawn.x >= 0 && IsValidMove(map, def.spawn.x, def.spawn.y)) {
+        return def.spawn;
+    }
+    PlayerState spawn = DefaultSpawn(map);
+    if (!IsValidMove(map, spawn.x, spawn.y)) GAMELOG_WARN("Level %d has no open tile to spawn on.", levelNum);
+    return spawn;
+}
+
+// (Re)creates a level's map in its slot, so pointers to it stay valid.
+// Small levels are generated whole so their point index (and the HUD total)
+// is complete from the start; on bigger ones chunks beyond the spawn area
+// come later, as the player nears.
+static GameMap* CreateLevelMap(int levelNum, int width, int height, uint64_t seed) {
+    LevelDef def;
+    if (levelNum < 1 || levelNum >= levelMapCount || !GetLevelDef(levelNum, &def)) return NULL;
+    GameMap* map = levelMaps[levelNum];
+    if (!map) map = levelMaps[levelNum] = malloc(sizeof(GameMap));
+    else MapFree(map);
+    if (!map || !MapInit(map, width, height, seed)) return NULL;
+    // Authored layers only fit the size they were made for
+    if (width == def.width && height == def.height) MapSetLayout(map, def.points, def.walls);
+
+    ChunkRequest requests[LEVEL_PREGEN_CHUNKS];
+    PlayerState spawn = LevelSpawn(levelNum, map);
+    bool whole = map->chunksX * map->chunksY <= LEVEL_PREGEN_CHUNKS;
+    int radius = whole ? ((map->chunksX > map->chunksY) ? map->chunksX : map->chunksY) : MAP_STREAM_RADIUS;
+    int count = CollectChunksAround(map, spawn.x, spawn.y, radius, requests, LEVEL_PREGEN_CHUNKS);
+    GenerateChunksParallel(requests, count, GetGenerationThreadCount());
+    return map;
+}
+
+// The level's map, created from its registry entry on first use. NULL if the
+// level doesn't exist or its entry is broken.
+static GameMap* GetLevelMap(int levelNum) {
+    if (levelNum < 1 || levelNum >= levelMapCount) return NULL;
+    if (levelMaps[levelNum] && levelMaps[levelNum]->chunks) return levelMaps[levelNum];
+
+    LevelDef def;
+    if (!GetLevelDef(levelNum, &def)) return NULL;
+    return CreateLevelMap(levelNum, def.width, def.height, LevelSeed(&def));
+}
+
+static void FreeLevelMaps(void) {
+    for (int l = 0; l < levelMapCount; l++) {
+        if (!levelMaps[l]) continue;
+        MapFree(levelMaps[l]);
+        free(levelMaps[l]);
+    }
+    free(levelMaps);
+    levelMaps = NULL;
+    levelMapCount = 0;
+}
+
 // ------------------------------------------------------------------
 // PUBLIC FUNCTIONS
 // ------------------------------------------------------------------
-void InitSceneSystem(void) {
-    // Generate Random Points
-    for(int l=1; l<=4; l++) {
-        for(int x=0; x<MAP_WIDTH; x++) {
-            for(int y=0; y<MAP_HEIGHT; y++) {
-                if (GetRandomValue(0, 7) == 0) {
-                    storedMaps[l].tiles[x][y].hasPoint = true;
-                } else {
-                    storedMaps[l].tiles[x][y].hasPoint = false;
-                }
-                storedMaps[l].tiles[x][y].isClaimed = false;
+void InitSceneSystem(uint64_t seed) {
+    PROFILE_BEGIN("InitSceneSystem");
+    sessionSeed = seed;
+
+    // Each level gets its own stream of the session seed. Only maps that
+    // already exist (played or resized) are rebuilt here, at their current
+    // size; the rest wait for their first entry, so this doesn't grow with
+    // the number of levels in the registry.
+    int count = LevelCount() + 1;
+    if (levelMapCount != count) {
+        FreeLevelMaps();
+        levelMaps = calloc(count, sizeof(GameMap*));
+        levelMapCount = levelMaps ? count : 0;
+    }
+    for (int l = 1; l < levelMapCount; l++) {
+        GameMap* map = levelMaps[l];
+        LevelDef def;
+        if (!map || !GetLevelDef(l, &def)) continue;
+        CreateLevelMap(l, map->width, map->height, LevelSeed(&def));
+    }
+    DistFieldInvalidate(&hintField); // Same map storage, new contents
+    InvalidateMinimap();
+    InitScenePool();
+    backdropState.map = NULL;
+    if (!rewindHistory.deltas && RewindInit(&rewindHistory, REWIND_CAPACITY)) {
+        GAMELOG_INFO("Rewind history: %d steps in %d bytes.", rewindHistory.capacity,
+                     (int)RewindBytes(&rewindHistory));
+    }
+    menuPage = 0;
+    PROFILE_END();
+}
+
+uint64_t GetSessionSeed(void) {
+    return sessionSeed;
+}
+
+void ShutdownSceneSystem(void) {
+    FreeLevelMaps();
+    RewindFree(&rewindHistory);
+    DistFieldFree(&hintField);
+}
+
+bool ResizeLevelMap(int levelNum, int width, int height) {
+    LevelDef def;
+    if (!GetLevelDef(levelNum, &def)) return false;
+    if (width < 1 || height < 1 || width > MAP_MAX_SIDE || height > MAP_MAX_SIDE) return false;
+
+    DistFieldInvalidate(&hintField);
+    InvalidateMinimap();
+    if (stagedLevel->level == levelNum) stagedLevel->map = NULL; // Its spawn may no longer fit
+    backdropState.map = NULL;
+    return CreateLevelMap(levelNum, width, height, LevelSeed(&def)) != NULL;
+}
+
+// Applies one journal record on top of the restored snapshot
+static void ApplyJournalRecord(const JournalRecord* r, void* ctx) {
+    // Levels first played after the snapshot are only in the journal
+    GameMap* map = GetLevelMap(r->level);
+    if (!map || !MapInBounds(map, r->x, r->y)) return;
+
+    if (r->type == JOURNAL_CLAIM) {
+        if (MapClaimPoint(map, r->x, r->y)) globalScore++;
+    } else {
+        hasContinue = true;
+        continueLevel = r->level;
+        continuePlayer = (PlayerState){ r->x, r->y, (Direction)(r->facing & 3) };
+    }
+}
+
+static SaveContents CurrentSaveContents(void) {
+    SaveContents contents;
+    bool inLevel = LevelInProgress();
+
+    contents.sessionSeed = sessionSeed;
+    contents.score = globalScore;
+    contents.lastLevel = inLevel ? lastActiveLevel : (hasContinue ? continueLevel : 0);
+    contents.player = inLevel ? liveLevel->player : continuePlayer;
+    contents.maps = levelMaps + 1;
+    contents.levelCount = levelMapCount - 1;
+    return contents;
+}
+
+// The background write finished: the journal moves over to the new snapshot,
+// keeping what was appended while it was being written
+static void FinishCompaction(uint64_t id) {
+    if (id == 0) {
+        GAMELOG_WARN("Autosave: cannot write %s, keeping the previous snapshot", savePath);
+        return;
+    }
+    if (journal.fd >= 0) JournalRebase(&journal, id, compactedRecords);
+}
+
+// Folds the journal into a fresh snapshot. The snapshot is captured here and
+// written in the background; UpdateSaveGame swaps the journal once it's on disk.
+static bool CompactSaveGame(void) {
+    if (saveWriter.busy) {
+        compactPending = true;
+        return true;
+    }
+    SaveContents contents = CurrentSaveContents();
+    SaveImage image;
+    if (!SaveCaptureSnapshot(&image, &contents)) return false;
+    journalStale = false;
+    compactPending = false;
+    compactedRecords = journal.records;
+    SaveWriterStart(&saveWriter, savePath, &image);
+    return true;
+}
+
+// Writes the snapshot and starts a new, empty journal before returning, for
+// opening and closing the save
+static bool WriteSaveGameNow(void) {
+    if (saveWriter.busy) FinishCompaction(SaveWriterWait(&saveWriter));
+    SaveContents contents = CurrentSaveContents();
+    uint64_t id = SaveWriteSnapshot(savePath, &contents);
+    if (id == 0) return false;
+    journalStale = false;
+    compactPending = false;
+    if (journal.fd >= 0) {
+        JournalReset(&journal, id);
+        return journal.fd >= 0;
+    }
+    return JournalOpen(&journal, journalPath, id);
+}
+
+bool OpenSaveGame(const char* basePath, bool startFresh) {
+    snprintf(savePath, sizeof(savePath), "%s.bin", basePath);
+    snprintf(journalPath, sizeof(journalPath), "%s.journal", basePath);
+
+    SaveFile save;
+    bool restored = !startFresh && SaveMapFile(&save, savePath);
+
+    if (restored) {
+        const SaveHeader* h = save.header;
+        sessionSeed = h->sessionSeed;
+        globalScore = h->score;
+        hasContinue = (h->lastLevel >= 1 && h->lastLevel < levelMapCount);
+        continueLevel = hasContinue ? h->lastLevel : 1;
+        continuePlayer = (PlayerState){ h->playerX, h->playerY, (Direction)(h->playerFacing & 3) };
+
+        // Levels come back from their seeds; only claims are stored, and only
+        // for levels that have any. Levels are matched by number, so a pack
+        // that gained levels keeps old progress.
+        for (uint32_t i = 0; i < h->levelCount; i++) {
+            const SaveLevel* level = &save.levels[i];
+            if (level->level < 1 || level->level >= levelMapCount) continue;
+            GameMap* map = CreateLevelMap(level->level, level->width, level->height, level->seed);
+            if (!map) continue;
+
+            const uint32_t* claims = SaveLevelClaims(&save, (int)i);
+            for (uint32_t c = 0; c < level->claimCount; c++) {
+                int x = claims[c] & 0xFFFF;
+                int y = claims[c] >> 16;
+                if (MapInBounds(map, x, y)) MapClaimPoint(map, x, y);
             }
         }
+        int replayed = JournalReplay(journalPath, h->snapshotId, ApplyJournalRecord, NULL);
+        GAMELOG_INFO("Save restored: score %d, %d journal records.", globalScore, replayed);
+        SaveUnmapFile(&save);
     }
+
+    // Start from a compact base either way, so the journal only holds this session
+    if (!WriteSaveGameNow()) GAMELOG_WARN("Autosave unavailable: cannot write %s", savePath);
+    return restored;
+}
+
+void UpdateSaveGame(void) {
+    uint64_t id;
+    if (!SaveWriterPoll(&saveWriter, &id)) return;
+    FinishCompaction(id);
+    if (compactPending) CompactSaveGame();
+}
+
+void CloseSaveGame(void) {
+    if (journal.fd < 0) {
+        SaveWriterWait(&saveWriter);
+        return;
+    }
+    WriteSaveGameNow();
+    JournalClose(&journal);
 }
 
 Scene* GetActiveScene(void) {
-    return &activeScene;
+    return sceneStack[sceneDepth - 1];
 }
 
 void ChangeScene(SceneType newType) {
-    activeScene.type = newType;
+    PROFILE_BEGIN("ChangeScene");
     switch (newType) {
         case SCENE_MENU_MAIN: InitMenuMain(); break;
-        case SCENE_LEVEL_1:   InitLevel(1, true); break;
-        case SCENE_LEVEL_2:   InitLevel(2, true); break;
-        case SCENE_LEVEL_3:   InitLevel(3, true); break;
-        case SCENE_LEVEL_4:   InitLevel(4, true); break;
+        case SCENE_LEVEL:     InitLevel(lastActiveLevel); break;
         case SCENE_MENU_PAUSE: InitMenuPause(); break;
     }
+    PROFILE_END();
+}
+
+bool EnterLevel(int levelNum) {
+    PROFILE_BEGIN("ChangeScene");
+    bool entered = InitLevel(levelNum);
+    PROFILE_END();
+    return entered;
+}
+
+// Puts a level at its spawn in the given scene object, creating its map if needed
+static bool SetupLevelScene(Scene* scene, int levelNum) {
+    GameMap* map = GetLevelMap(levelNum);
+    scene->map = map;
+    if (!map) return false;
+    scene->level = levelNum;
+    scene->player = LevelSpawn(levelNum, map);
+    scene->prevPlayer = scene->player; // Don't interpolate across levels
+    scene->interpolation = 0.0f;
+    scene->input = CMD_NONE;
+    MapStreamAround(map, scene->player.x, scene->player.y);
+    return true;
+}
+
+void PreloadLevel(int levelNum) {
+    if (stagedLevel->map && stagedLevel->level == levelNum) return;
+    if (levelNum < 1 || levelNum > LevelCount()) return;
+    PROFILE_BEGIN("PreloadLevel");
+    PrefetchLevelTexture(levelNum);
+    SetupLevelScene(stagedLevel, levelNum);
+    PROFILE_END();
 }
 
 // ------------------------------------------------------------------
@@ -70,76 +443,252 @@ void ChangeScene(SceneType newType) {
 // ------------------------------------------------------------------
 
 // --- MAIN MENU ---
+// Labels only change with the page or the save, so they are formatted then
+// rather than every frame
+static void RefreshMenuLabels(void);
+
 void InitMenuMain(void) {
-    activeScene.Update = UpdateMenuMain;
-    activeScene.Draw = DrawMenuMain;
+    SetBaseScene(&menuScene);
+    menuScene.idle = false;
+    RefreshMenuLabels();
+    // The level we'd continue into is the likeliest pick, get it ready now
+    if (hasContinue) PreloadLevel(continueLevel);
+}
+
+static int MenuPageCount(void) {
+    return (LevelCount() + LEVELS_PER_PAGE - 1) / LEVELS_PER_PAGE;
+}
+
+// Level shown in a slot of the current page, 0 past the last level
+static int PageLevel(int slot) {
+    int levelNum = menuPage * LEVELS_PER_PAGE + slot + 1;
+    return (levelNum <= LevelCount()) ? levelNum : 0;
+}
+
+static Button LevelButton(int slot) {
+    return (Button){ (Rectangle){400, 250 + 80 * slot, 400, 60}, levelLabels[slot], GRAY };
+}
+
+static void RefreshMenuLabels(void) {
+    for (int slot = 0; slot < LEVELS_PER_PAGE; slot++) {
+        int levelNum = PageLevel(slot);
+        if (!levelNum) break;
+        LevelDef def;
+        snprintf(levelLabels[slot], sizeof(levelLabels[slot]), "Level %d: %.*s", levelNum,
+                 LEVEL_NAME_MAX - 1, GetLevelDef(levelNum, &def) ? def.name : "(unreadable)");
+    }
+    snprintf(continueText, sizeof(continueText), "Continue Level %d", continueLevel);
+}
+
+// Every button the main menu shows right now, in drawing order
+static int MenuButtons(Button* out) {
+    int count = 0;
+    for (int slot = 0; slot < LEVELS_PER_PAGE && PageLevel(slot); slot++) out[count++] = LevelButton(slot);
+    if (MenuPageCount() > 1) {
+        out[count++] = btnPrevPage;
+        out[count++] = btnNextPage;
+    }
+    if (hasContinue) out[count++] = btnContinue;
+    out[count++] = btnExit;
+    return count;
+}
+
+// Index + 1 of the button under the mouse, 0 for none. Hover is the only
+// thing a menu draws differently without a click.
+static int HoveredButton(const Button* buttons, int count) {
+    Vector2 mouse = GetInputMousePosition();
+    for (int i = 0; i < count; i++) {
+        if (CheckCollisionPointRec(mouse, buttons[i].rect)) return i + 1;
+    }
+    return 0;
+}
+
+void UpdateMenuMain(Scene* s) {
+    Vector2 mouse = GetInputMousePosition();
+    for (int slot = 0; slot < LEVELS_PER_PAGE; slot++) {
+        int levelNum = PageLevel(slot);
+        if (!levelNum) break;
+        Button btn = LevelButton(slot);
+        // Hovering a level is enough of a hint to start loading it
+        if (CheckCollisionPointRec(mouse, btn.rect)) PreloadLevel(levelNum);
+        if (GuiButtonPressed(btn) && EnterLevel(levelNum)) return;
+    }
+    if (MenuPageCount() > 1) {
+        int page = menuPage;
+        if (GuiButtonPressed(btnPrevPage)) menuPage = (menuPage + MenuPageCount() - 1) % MenuPageCount();
+        if (GuiButtonPressed(btnNextPage)) menuPage = (menuPage + 1) % MenuPageCount();
+        if (menuPage != page) RefreshMenuLabels();
+    }
+    if (hasContinue && GuiButtonPressed(btnContinue)) {
+        ContinueLevel();
+        return;
+    }
+    if (GuiButtonPressed(btnExit)) gameShouldClose = true;
+
+    Button buttons[MENU_MAX_BUTTONS];
+    int hover = HoveredButton(buttons, MenuButtons(buttons));
+    s->idle = (s->input == CMD_NONE && hover == menuHover);
+    menuHover = hover;
 }
-void UpdateMenuMain(Scene* s) {}
 void DrawMenuMain(Scene* s) {
     ClearBackground(DARKBLUE);
     DrawCenteredText("MAIN MENU", SCR_WIDTH/2, 100, 60, WHITE);
-    
-    Button btnL1 = { (Rectangle){400, 250, 400, 60}, "Level 1: Residence", GRAY };
-    Button btnL2 = { (Rectangle){400, 330, 400, 60}, "Level 2: Copse", GRAY };
-    Button btnL3 = { (Rectangle){400, 410, 400, 60}, "Level 3: Hospital", GRAY };
-    Button btnL4 = { (Rectangle){400, 490, 400, 60}, "Level 4: Dungeon", GRAY };
-    Button btnExit = {(Rectangle){400, 650, 400, 60}, "EXIT GAME", MAROON};
+    if (MenuPageCount() > 1) {
+        char pageText[32];
+        snprintf(pageText, sizeof(pageText), "Page %d / %d", menuPage + 1, MenuPageCount());
+        DrawCenteredText(pageText, SCR_WIDTH/2, 200, 20, RAYWHITE);
+    }
 
-    if (GuiButton(btnL1)) ChangeScene(SCENE_LEVEL_1);
-    if (GuiButton(btnL2)) ChangeScene(SCENE_LEVEL_2);
-    if (GuiButton(btnL3)) ChangeScene(SCENE_LEVEL_3);
-    if (GuiButton(btnL4)) ChangeScene(SCENE_LEVEL_4);
-    if (GuiButton(btnExit)) gameShouldClose = true;
+    // Only the visible page has buttons, however many levels there are
+    Button buttons[MENU_MAX_BUTTONS];
+    int count = MenuButtons(buttons);
+    for (int i = 0; i < count; i++) DrawGuiButton(buttons[i]);
 }
 
 // --- LEVEL ---
-void InitLevel(int levelNum, bool resetPosition) {
-    activeScene.type = levelNum;
-    activeScene.Update = UpdateLevel;
-    activeScene.Draw = DrawLevel;
+// A preloaded level just swaps in; anything else is set up in the live slot
+bool InitLevel(int levelNum) {
+    if (stagedLevel->map && stagedLevel->level == levelNum) {
+        Scene* previous = liveLevel;
+        liveLevel = stagedLevel;
+        stagedLevel = previous;
+        stagedLevel->map = NULL;
+    } else if (!SetupLevelScene(liveLevel, levelNum)) {
+        GAMELOG_WARN("Level %d cannot be loaded.", levelNum);
+        SetBaseScene(&menuScene);
+        return false;
+    }
+    SetBaseScene(liveLevel);
     lastActiveLevel = levelNum;
-    activeScene.map = storedMaps[levelNum];
+    autoWalk = false;
+    hasContinue = false;
+    RewindReset(&rewindHistory, liveLevel->map, liveLevel->player, globalScore);
 
-    if (resetPosition) {
-        activeScene.player = (PlayerState){5, 5, DIR_NORTH};
-    } else {
-        activeScene.player = storedPlayerStates[levelNum];
+    PlayerState* p = &liveLevel->player;
+    JournalAppend(&journal, JOURNAL_MOVE, levelNum, p->x, p->y, p->facing);
+    return true;
+}
+
+// Re-enters the level that was in progress when the save was written
+void ContinueLevel(void) {
+    PlayerState saved = continuePlayer;
+    if (!InitLevel(continueLevel)) return;
+    if (MapInBounds(liveLevel->map, saved.x, saved.y)) {
+        liveLevel->player = saved;
+        liveLevel->prevPlayer = saved;
+        MapStreamAround(liveLevel->map, saved.x, saved.y);
+        RewindReset(&rewindHistory, liveLevel->map, saved, globalScore);
+        JournalAppend(&journal, JOURNAL_MOVE, continueLevel, saved.x, saved.y, saved.facing);
     }
 }
 
+// Back to the paused level: the overlay comes off the stack and the level
+// scene under it was never touched, so nothing is re-initialized or copied
+void ResumeLevel(void) {
+    PopScene();
+}
+
 void UpdateLevel(Scene* s) {
-    if (IsKeyPressed(KEY_ESCAPE)) {
-        storedPlayerStates[s->type] = s->player;
+    if (s->input & CMD_PAUSE) {
+        // Pausing is a natural point to fold a long journal into the snapshot
+        if (journalStale || journal.records >= SAVE_COMPACT_RECORDS) CompactSaveGame();
         ChangeScene(SCENE_MENU_PAUSE);
         return;
     }
-    
+    if (s->input & CMD_REWIND) {
+        autoWalk = false; // Would walk straight back
+        int claimsBefore = s->map->claimLogCount;
+        if (RewindSteps(&rewindHistory, s->map, 1, &s->player, &globalScore) > 0) {
+            MapStreamAround(s->map, s->player.x, s->player.y);
+            // The journal can only add claims, so undone ones go out in a new
+            // snapshot, written once the rewind is released rather than per tick
+            if (journal.fd >= 0 && s->map->claimLogCount < claimsBefore) journalStale = true;
+            // Undone claims bumped the rollback generation, so this rebuilds
+            DistFieldSync(&hintField, s->map, s->player.x, s->player.y);
+        }
+        return;
+    }
+
+    if (journalStale) CompactSaveGame();
+
+    // Auto-walk fills in for the player only while no movement key is pressed
+    InputFrame move = s->input;
+    if (s->input & CMD_AUTO_WALK) autoWalk = !autoWalk;
+    if (autoWalk && !(move & (CMD_TURN_LEFT | CMD_TURN_RIGHT | CMD_STEP)) &&
+        ++autoWalkTicks >= AUTO_WALK_INTERVAL) {
+        Direction toward;
+        autoWalkTicks = 0;
+        if (DistFieldNextStep(&hintField, s->player.x, s->player.y, &toward)) {
+            move = SteerTowards(&s->player, toward);
+        }
+    }
+
     // Core Logic
-    HandlePlayerMovement(&s->player);
-    CheckPointCollection(s, &globalScore, &storedMaps[s->type]);
+    int scoreBefore = globalScore;
+    if (HandlePlayerMovement(&s->player, s->map, move)) {
+        JournalAppend(&journal, JOURNAL_MOVE, s->level, s->player.x, s->player.y, s->player.facing);
+    }
+    MapStreamAround(s->map, s->player.x, s->player.y);
+    CheckPointCollection(s, &globalScore);
+    if (globalScore != scoreBefore) {
+        JournalAppend(&journal, JOURNAL_CLAIM, s->level, s->player.x, s->player.y, s->player.facing);
+    }
+    RewindRecord(&rewindHistory, s->map, s->player, globalScore);
+    // Builds on the first tick in a level, then repairs only around new claims
+    DistFieldSync(&hintField, s->map, s->player.x, s->player.y);
+    // The player will most likely move on next, have that level ready
+    if (MapLevelComplete(s->map) && s->level < LevelCount()) PreloadLevel(s->level + 1);
 }
 
 void DrawLevel(Scene* s) {
     DrawLevelView(s);
     DrawHUD(s, globalScore);
+    UpdateMinimap(s);
+    DrawMinimap(20, SCR_HEIGHT - 200, 180);
+
+    Direction toward;
+    if (MapLevelComplete(s->map)) {
+        DrawCenteredText("LEVEL COMPLETE", SCR_WIDTH/2, SCR_HEIGHT - 120, 40, GOLD);
+    } else if (hintField.map == s->map && DistFieldNextStep(&hintField, s->player.x, s->player.y, &toward)) {
+        DrawHintArrow(s, toward, DistFieldGet(&hintField, s->player.x, s->player.y), autoWalk);
+    }
 }
 
 // --- PAUSE ---
 void InitMenuPause(void) {
-    activeScene.Update = UpdateMenuPause;
-    activeScene.Draw = DrawMenuPause;
+    if (GetActiveScene() != liveLevel) return;
+    // Only a level that changed since the last pause needs a new backdrop
+    const GameMap* map = liveLevel->map;
+    PlayerState p = liveLevel->player;
+    if (backdropState.map != map || backdropState.claims != map->claimLogCount ||
+        backdropState.rollbackGen != map->rollbackGen ||
+        backdropState.player.x != p.x || backdropState.player.y != p.y ||
+        backdropState.player.facing != p.facing) {
+        InvalidateFrozenBackdrop();
+        backdropState.map = map;
+        backdropState.player = p;
+        backdropState.claims = map->claimLogCount;
+        backdropState.rollbackGen = map->rollbackGen;
+    }
+    pauseScene.idle = false;
+    PushScene(&pauseScene);
 }
 void UpdateMenuPause(Scene* s) {
-    if (IsKeyPressed(KEY_ESCAPE)) InitLevel(lastActiveLevel, false);
+    if ((s->input & CMD_PAUSE) || GuiButtonPressed(btnResume)) ResumeLevel();
+    else if (GuiButtonPressed(btnExit)) gameShouldClose = true;
+
+    const Button buttons[] = { btnResume, btnExit };
+    int hover = HoveredButton(buttons, 2);
+    s->idle = (s->input == CMD_NONE && hover == pauseHover);
+    pauseHover = hover;
 }
 void DrawMenuPause(Scene* s) {
-    DrawLevelView(s); // Draw background
-    DrawRectangle(0,0, SCR_WIDTH, SCR_HEIGHT, Fade(BLACK, 0.6f));
+    // The paused level is frozen, so it's rendered and dimmed once
+    const Scene* below = SceneBelow(s);
+    if (below) UpdateFrozenBackdrop(below->level);
+    DrawFrozenBackdrop();
     DrawCenteredText("PAUSED", SCR_WIDTH/2, 100, 60, RAYWHITE);
 
-    Button btnResume = { (Rectangle){400, 250, 400, 60}, "RESUME", LIGHTGRAY };
-    Button btnExit = {(Rectangle){400, 650, 400, 60}, "EXIT GAME", MAROON};
-
-    if (GuiButton(btnResume)) InitLevel(lastActiveLevel, false);
-    if (GuiButton(btnExit)) gameShouldClose = true;
+    DrawGuiButton(btnResume);
+    DrawGuiButton(btnExit);
 }
\ No newline at end of file
@@ -7,13 +7,45 @@
 extern int globalScore;
 extern bool gameShouldClose;
 
-// Initializes the Scene System (maps, etc.)
-void InitSceneSystem(void);
+// Initializes the Scene System (maps, etc.). Load the level registry first.
+// Every level layout derives from the session seed, so a seed replays a session.
+void InitSceneSystem(uint64_t seed);
 
-// The Main Scene Switcher
+// Seed passed to InitSceneSystem
+uint64_t GetSessionSeed(void);
+
+// Frees all level maps (Call once at exit)
+void ShutdownSceneSystem(void);
+
+// Restores progress from <basePath>.bin/.journal unless startFresh, then keeps
+// autosaving there: one journal record per move/claim, compacted on pause/exit.
+// Returns true if a save was restored (its seed replaces the session seed).
+bool OpenSaveGame(const char* basePath, bool startFresh);
+
+// Swaps the journal over once a background snapshot write is on disk
+// (Call once per frame)
+void UpdateSaveGame(void);
+
+// Folds the journal into a final snapshot (Call once at exit)
+void CloseSaveGame(void);
+
+// Replaces a level's map with a fresh one of the given size, dropping its progress
+bool ResizeLevelMap(int levelNum, int width, int height);
+
+// The Main Scene Switcher. Scenes come from a pool set up once, so this only
+// moves pointers: SCENE_MENU_PAUSE pushes the pause overlay on the live level,
+// SCENE_MENU_MAIN and SCENE_LEVEL (the last level played) replace the stack.
 void ChangeScene(SceneType newType);
 
-// Access to the active scene for Main loop
+// Starts level levelNum (1..LevelCount()) from its spawn point, creating its
+// map on first entry. False if the registry can't provide it.
+bool EnterLevel(int levelNum);
+
+// Readies a level in a spare scene (map generated, spawn streamed, background
+// requested) so a later EnterLevel of it is a swap. One level is kept ready.
+void PreloadLevel(int levelNum);
+
+// Access to the active scene (top of the scene stack) for Main loop
 Scene* GetActiveScene(void);
 
 #endif // SCENES_H
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "simulation.h"
+#include "coremechanics.h"
+#include "gamemap.h"
+#include <stddef.h>
+
+// ------------------------------------------------------------------
+// SESSION
+// ------------------------------------------------------------------
+static void StartSession(SimSession* sim, int levelNum, GameMap* map) {
+    sim->scene.type = SCENE_LEVEL;
+    sim->scene.level = levelNum;
+    sim->scene.map = map;
+    sim->scene.player = DefaultSpawn(map);
+    sim->scene.input = CMD_NONE;
+    sim->scene.Update = NULL;
+    sim->scene.Draw = NULL;
+    sim->score = 0;
+    sim->paused = false;
+    sim->ticks = 0;
+    sim->rewind = NULL;
+
+    MapStreamAround(map, sim->scene.player.x, sim->scene.player.y);
+}
+
+bool SimInitSession(SimSession* sim, int levelNum, int width, int height, uint64_t seed) {
+    if (!MapInit(&sim->ownMap, width, height, seed)) return false;
+    sim->ownsMap = true;
+    sim->baseMark = 0;
+    StartSession(sim, levelNum, &sim->ownMap);
+    return true;
+}
+
+void SimForkSession(SimSession* sim, int levelNum, GameMap* base) {
+    sim->ownsMap = false;
+    sim->baseMark = MapMark(base);
+    StartSession(sim, levelNum, base);
+}
+
+void SimFreeSession(SimSession* sim) {
+    if (sim->ownsMap) {
+        MapFree(&sim->ownMap);
+    } else if (sim->scene.map) {
+        MapRollback(sim->scene.map, sim->baseMark);
+    }
+    sim->scene.map = NULL;
+}
+
+void SimStep(SimSession* sim, InputFrame input) {
+    sim->ticks++;
+    sim->scene.input = input;
+
+    // Pausing freezes the level until the next pause command, like the pause menu
+    if (input & CMD_PAUSE) {
+        sim->paused = !sim->paused;
+        return;
+    }
+    if (sim->paused) return;
+
+    if ((input & CMD_REWIND) && sim->rewind) {
+        RewindSteps(sim->rewind, sim->scene.map, 1, &sim->scene.player, &sim->score);
+        MapStreamAround(sim->scene.map, sim->scene.player.x, sim->scene.player.y);
+        return;
+    }
+    HandlePlayerMovement(&sim->scene.player, sim->scene.map, input);
+    MapStreamAround(sim->scene.map, sim->scene.player.x, sim->scene.player.y);
+    CheckPointCollection(&sim->scene, &sim->score);
+    if (sim->rewind) RewindRecord(sim->rewind, sim->scene.map, sim->scene.player, sim->score);
+}
+
+int SimRun(SimSession* sim, const InputFrame* inputs, int count) {
+    for (int i = 0; i < count; i++) {
+        SimStep(sim, inputs[i]);
+    }
+    return sim->score;
+}
+
+// ------------------------------------------------------------------
+// SCRIPTS
+// ------------------------------------------------------------------
+int SimParseScript(const char* script, InputFrame* out, int maxFrames) {
+    int count = 0;
+    for (const char* c = script; *c && count < maxFrames; c++) {
+        switch (*c) {
+            case 'a': out[count++] = CMD_TURN_LEFT; break;
+            case 'd': out[count++] = CMD_TURN_RIGHT; break;
+            case 'w': out[count++] = CMD_STEP; break;
+            case 'p': out[count++] = CMD_PAUSE; break;
+            case 'r': out[count++] = CMD_REWIND; break;
+            case '.': out[count++] = CMD_NONE; break;
+            default: break; // Whitespace and unknown characters are ignored
+        }
+    }
+    return count;
+}
@@ -0,0 +1,43 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "types.h"
+#include "rewind.h"
+
+// A self-contained level session that runs without a window or GL context.
+// Either owns a map or runs on top of a shared one and rolls its claims back
+// when freed, so many sessions can run back to back on the same level.
+// scene.map may point into the session itself, so sessions must not be copied.
+typedef struct SimSession {
+    Scene scene;
+    GameMap ownMap;
+    bool ownsMap;
+    int baseMark;     // Claim log position of a shared map at fork time
+    int score;
+    bool paused;
+    long ticks;
+    RewindBuffer* rewind; // Optional: set after init to record steps and obey CMD_REWIND
+} SimSession;
+
+// Starts a session on a fresh lazily generated map at the default spawn
+bool SimInitSession(SimSession* sim, int levelNum, int width, int height, uint64_t seed);
+
+// Starts a session on an existing map without copying it. Only one forked
+// session may run on a given map at a time.
+void SimForkSession(SimSession* sim, int levelNum, GameMap* base);
+
+// Releases an owned map, or rolls a shared one back to its state at fork time
+void SimFreeSession(SimSession* sim);
+
+// Advances the session by one tick, same rules as UpdateLevel/UpdateMenuPause
+void SimStep(SimSession* sim, InputFrame input);
+
+// Feeds a whole input buffer through the session, returns the final score
+int SimRun(SimSession* sim, const InputFrame* inputs, int count);
+
+// Parses a script into one command per character:
+// a/d turn, w step, p pause toggle, r rewind one step, '.' idle.
+// Returns frames written.
+int SimParseScript(const char* script, InputFrame* out, int maxFrames);
+
+#endif // SIMULATION_H
@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 200809L
+#include "swarm.h"
+#include "coremechanics.h"
+#include "gamemap.h"
+#include "levelgen.h"
+#include "workpool.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// One worker's share of the agent blocks, taken front to back. The owner and
+// any thief both take with fetch_add, so a block is never stepped twice.
+// Aligned so workers never share a cache line.
+typedef struct SwarmWorker {
+    alignas(64) atomic_int next;  // Next block in [first, end) to hand out
+    int first, end;
+    TilePos* claims;              // Points this worker won during the tick
+    int claimCount;
+    long steals;
+} SwarmWorker;
+
+struct Swarm {
+    GameMap* map;
+    SwarmAgent* agents;
+    int agentCount;
+    int blockCount;
+    WorkPool* pool;
+    int threadCount;
+    SwarmWorker workers[SWARM_MAX_THREADS];
+};
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+
+// Same mix as the headless random-walk bot, minus pausing
+static InputFrame AgentInput(Rng* rng) {
+    uint32_t r = RngRange(rng, 100);
+    if (r < 60) return CMD_STEP;
+    return (r < 80) ? CMD_TURN_LEFT : CMD_TURN_RIGHT;
+}
+
+static void StepBlock(Swarm* s, SwarmWorker* w, int block) {
+    int first = block * SWARM_BLOCK_AGENTS;
+    int end = first + SWARM_BLOCK_AGENTS;
+    if (end > s->agentCount) end = s->agentCount;
+
+    for (int i = first; i < end; i++) {
+        SwarmAgent* a = &s->agents[i];
+        HandlePlayerMovement(&a->player, s->map, AgentInput(&a->rng));
+        if (MapTryClaimAtomic(s->map, a->player.x, a->player.y)) {
+            a->score++;
+            w->claims[w->claimCount++] = (TilePos){ a->player.x, a->player.y };
+        }
+    }
+}
+
+// Own queue first, then the others in turn until every queue is drained
+static void SwarmJob(void* ctx, int worker) {
+    Swarm* s = ctx;
+    SwarmWorker* w = &s->workers[worker];
+    w->claimCount = 0;
+    for (int k = 0; k < s->threadCount; k++) {
+        SwarmWorker* victim = &s->workers[(worker + k) % s->threadCount];
+        for (;;) {
+            int block = atomic_fetch_add_explicit(&victim->next, 1, memory_order_relaxed);
+            if (block >= victim->end) break;
+            if (k > 0) w->steals++;
+            StepBlock(s, w, block);
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+Swarm* SwarmCreate(GameMap* map, int agentCount, int threadCount, uint64_t seed) {
+    if (agentCount < 1) agentCount = 1;
+    if (threadCount > SWARM_MAX_THREADS) threadCount = SWARM_MAX_THREADS;
+
+    Swarm* s = calloc(1, sizeof(Swarm));
+    if (!s) return NULL;
+    s->map = map;
+    s->agentCount = agentCount;
+    s->blockCount = (agentCount + SWARM_BLOCK_AGENTS - 1) / SWARM_BLOCK_AGENTS;
+    s->agents = malloc(agentCount * sizeof(SwarmAgent));
+    s->pool = PoolCreate(threadCount);
+    if (!s->agents || !s->pool) {
+        SwarmDestroy(s);
+        return NULL;
+    }
+    s->threadCount = PoolThreadCount(s->pool);
+
+    // Claims only land on resident chunks, so the whole level is generated now
+    PregenerateMap(map, s->threadCount);
+
+    for (int i = 0; i < agentCount; i++) {
+        SwarmAgent* a = &s->agents[i];
+        a->rng = RngStream(seed, (uint64_t)i);
+        a->player.x = (int)RngRange(&a->rng, (uint32_t)map->width);
+        a->player.y = (int)RngRange(&a->rng, (uint32_t)map->height);
+        a->player.facing = (Direction)RngRange(&a->rng, 4);
+        while (a->player.x > 0 && !IsValidMove(map, a->player.x, a->player.y)) a->player.x--;
+        a->score = 0;
+    }
+
+    // A worker can't win more points in a tick than there are agents
+    for (int t = 0; t < s->threadCount; t++) {
+        SwarmWorker* w = &s->workers[t];
+        w->first = (int)((long)s->blockCount * t / s->threadCount);
+        w->end = (int)((long)s->blockCount * (t + 1) / s->threadCount);
+        atomic_init(&w->next, w->end);
+        w->claims = malloc(agentCount * sizeof(TilePos));
+        if (!w->claims) {
+            SwarmDestroy(s);
+            return NULL;
+        }
+    }
+    return s;
+}
+
+void SwarmDestroy(Swarm* swarm) {
+    if (!swarm) return;
+    PoolDestroy(swarm->pool);
+    for (int t = 0; t < SWARM_MAX_THREADS; t++) free(swarm->workers[t].claims);
+    free(swarm->agents);
+    free(swarm);
+}
+
+int SwarmTick(Swarm* swarm) {
+    for (int t = 0; t < swarm->threadCount; t++) {
+        atomic_store_explicit(&swarm->workers[t].next, swarm->workers[t].first, memory_order_relaxed);
+    }
+    PoolRun(swarm->pool, SwarmJob, swarm);
+
+    // Counts, the point index and the claim log are single-threaded
+    int claimed = 0;
+    for (int t = 0; t < swarm->threadCount; t++) {
+        MapCommitClaims(swarm->map, swarm->workers[t].claims, swarm->workers[t].claimCount);
+        claimed += swarm->workers[t].claimCount;
+    }
+    return claimed;
+}
+
+const SwarmAgent* SwarmGetAgents(const Swarm* swarm, int* count) {
+    *count = swarm->agentCount;
+    return swarm->agents;
+}
+
+int SwarmThreadCount(const Swarm* swarm) {
+    return swarm->threadCount;
+}
+
+long SwarmSteals(const Swarm* swarm) {
+    long steals = 0;
+    for (int t = 0; t < swarm->threadCount; t++) steals += swarm->workers[t].steals;
+    return steals;
+}
@@ -0,0 +1,44 @@
+#ifndef SWARM_H
+#define SWARM_H
+
+#include "types.h"
+#include "rng.h"
+
+// Multi-agent mode for load-testing levels: thousands of bots walk one shared
+// map under the player's movement rules, updated in parallel. Claims go
+// through MapTryClaimAtomic, so every point is credited to exactly one agent;
+// which agent wins a contested point depends on thread timing, but the set of
+// claimed points does not.
+
+#define SWARM_MAX_THREADS 64   // Same as POOL_MAX_THREADS
+#define SWARM_BLOCK_AGENTS 64   // Agents per unit of work
+
+typedef struct SwarmAgent {
+    PlayerState player;
+    Rng rng;              // Drives this agent's inputs only
+    int score;
+} SwarmAgent;
+
+typedef struct Swarm Swarm;
+
+// Generates the whole map, spawns agents at random tiles and starts a worker
+// pool (the calling thread works too). Nothing else may stream,
+// edit or claim on the map while the swarm runs. NULL if out of memory.
+Swarm* SwarmCreate(GameMap* map, int agentCount, int threadCount, uint64_t seed);
+
+// Stops the workers and frees the swarm; the map keeps its claims
+void SwarmDestroy(Swarm* swarm);
+
+// Steps every agent once and commits the tick's claims to the map.
+// Returns the number of points claimed this tick.
+int SwarmTick(Swarm* swarm);
+
+const SwarmAgent* SwarmGetAgents(const Swarm* swarm, int* count);
+
+// Threads actually running (the requested count, clamped)
+int SwarmThreadCount(const Swarm* swarm);
+
+// Blocks taken from another worker's queue since creation
+long SwarmSteals(const Swarm* swarm);
+
+#endif // SWARM_H
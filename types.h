@@ -2,6 +2,7 @@
 #define TYPES_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "raylib.h"
 
 // --------------------------------------------------------------------------------------
@@ -9,8 +10,15 @@
 // --------------------------------------------------------------------------------------
 #define SCR_WIDTH 1200
 #define SCR_HEIGHT 900
-#define MAP_WIDTH 10
+#define MAP_WIDTH 10          // Default size of the built-in levels
 #define MAP_HEIGHT 10
+#define MAP_MAX_SIDE 65536    // Largest runtime map side, in tiles
+
+// Maps are stored as square chunks of CHUNK_SIZE tiles; one uint64_t per chunk row
+#define CHUNK_SHIFT 6
+#define CHUNK_SIZE (1 << CHUNK_SHIFT)
+#define MAP_STREAM_RADIUS 1   // Chunks kept generated around the player
+#define MAP_EVICT_RADIUS 3    // Chunks farther than this get evicted
 
 // --------------------------------------------------------------------------------------
 // ENUMS
@@ -22,15 +30,30 @@ typedef enum {
     DIR_WEST=3 
 } Direction;
 
+// Which level a SCENE_LEVEL plays is Scene.level, an index into the level registry
 typedef enum { 
     SCENE_MENU_MAIN = 0,
-    SCENE_LEVEL_1 = 1,
-    SCENE_LEVEL_2 = 2,
-    SCENE_LEVEL_3 = 3,
-    SCENE_LEVEL_4 = 4,
-    SCENE_MENU_PAUSE = 5
+    SCENE_LEVEL = 1,
+    SCENE_MENU_PAUSE = 2
 } SceneType;
 
+// Per-tick input commands, one bit each so a tick can carry several.
+// Filled from the keyboard in windowed builds and from scripted buffers
+// in the headless simulation.
+typedef enum {
+    CMD_NONE       = 0,
+    CMD_TURN_LEFT  = 1 << 0,
+    CMD_TURN_RIGHT = 1 << 1,
+    CMD_STEP       = 1 << 2,
+    CMD_PAUSE      = 1 << 3,
+    CMD_CLICK      = 1 << 4,  // Left mouse button released (menu buttons)
+    CMD_AUTO_WALK  = 1 << 5,  // Toggle walking to the nearest point
+    CMD_REWIND     = 1 << 6,  // Undo the last move (see rewind.h)
+    CMD_HIGHEST    = CMD_REWIND // Keep on the highest bit: replays need the one above it
+} InputCommand;
+
+typedef unsigned char InputFrame;
+
 // NEW: The State Machine for the game flow
 typedef enum {
     STATE_EXPLORE,
@@ -50,13 +73,67 @@ typedef struct Button {
 } Button;
 
 // -- MAP & TILES --
+// By-value view of a single tile; the map itself stores packed bitplanes
 typedef struct Tile {
     bool hasPoint;
     bool isClaimed;
 } Tile;
 
+typedef struct TilePos {
+    int x, y;
+} TilePos;
+
+// Tile bits of one chunk: bit x of row y is tile (x, y) inside the chunk.
+// claimedRows is always a subset of pointRows, and no point sits on a wall.
+// Tiles past the map's edge are walls. exitRows holds each tile's exit mask
+// (see MapExits), 16 tiles a word: tile x is nibble x & 15 of word x >> 4.
+typedef struct MapChunk {
+    uint64_t pointRows[CHUNK_SIZE];
+    uint64_t claimedRows[CHUNK_SIZE];
+    uint64_t wallRows[CHUNK_SIZE];
+    uint64_t exitRows[CHUNK_SIZE][CHUNK_SIZE / 16];
+} MapChunk;
+
+// One entry of a map's point index. rank is the point's position among its
+// chunk's points in row-major order, which keys the chunk's slot table.
+typedef struct PointRef {
+    uint16_t x, y;
+    uint16_t rank;
+} PointRef;
+
+// Bookkeeping for a chunk that has been generated at least once.
+// While evicted, tiles is NULL and its claims live on as a sorted offset list.
+typedef struct ChunkRecord {
+    MapChunk* tiles;
+    uint16_t* savedClaims;
+    int savedClaimCount;
+    int pointCount;
+    int claimedCount;
+    int* slots;                   // Point index slot of each point, by rank
+    uint16_t rowRank[CHUNK_SIZE]; // Points in the rows above each row
+    bool edited;          // Changed by MapSetPoint, can't be regenerated
+} ChunkRecord;
+
+// Runtime-sized map. Chunks are generated from the seed on first access
+// and evicted again when the player streams far away from them.
 typedef struct GameMap {
-    Tile tiles[MAP_WIDTH][MAP_HEIGHT];
+    int width, height;        // In tiles
+    int chunksX, chunksY;
+    uint64_t seed;            // Chunk streams are split off this
+    const uint64_t* layout;   // Authored point rows (see levelpack.h), NULL to generate from seed
+    const uint64_t* walls;    // Authored wall rows, same layout. NULL: pillars if generated, else none
+    ChunkRecord** chunks;     // chunksX * chunksY, NULL until generated
+    int* resident;            // Indices of chunks whose tiles are in memory
+    int residentCount, residentCapacity;
+    int generatedChunks;
+    int pointCount;           // Totals over all generated chunks
+    int claimedCount;
+    int streamCx, streamCy;   // Chunk the map was last streamed around
+    TilePos* claimLog;        // Every claim in order; snapshots are log lengths
+    int claimLogCount, claimLogCapacity;
+    int rollbackGen;          // Bumped whenever claims are undone; the log alone can regrow to the same length
+    PointRef* pointIndex;     // Every generated point: unclaimed ones first, then claimed
+    int pointIndexCapacity;
 } GameMap;
 
 // -- PLAYER --
@@ -71,8 +148,13 @@ typedef struct Scene Scene;
 
 struct Scene {
     SceneType type;
+    int level;              // Registry level number (1-based) of the level being played
     PlayerState player;
-    GameMap map; 
+    PlayerState prevPlayer; // Player before the last tick, for interpolated drawing
+    float interpolation;    // 0..1 progress from prevPlayer to player, set before Draw
+    GameMap* map;     // Points at the level's stored map, never a copy
+    InputFrame input; // Commands for the current tick, set before Update
+    bool idle;        // Set by Update: drawing again would give the same frame until new input arrives
     
     // Logic Pointers
     void (*Update)(Scene* self);
@@ -0,0 +1,113 @@
+#define _POSIX_C_SOURCE 200809L
+#include "workpool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef struct PoolHelper {
+    WorkPool* pool;
+    int worker;
+} PoolHelper;
+
+struct WorkPool {
+    int threadCount;
+    pthread_t threads[POOL_MAX_THREADS];
+    PoolHelper helpers[POOL_MAX_THREADS];
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;     // A new job (or shutdown) was posted
+    pthread_cond_t done;      // The last helper finished the job
+    PoolJob job;
+    void* ctx;
+    int generation;
+    int finished;
+    bool stopping;
+};
+
+// ------------------------------------------------------------------
+// INTERNAL HELPERS
+// ------------------------------------------------------------------
+static void* PoolThread(void* arg) {
+    PoolHelper* helper = arg;
+    WorkPool* pool = helper->pool;
+    int seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stopping) pthread_cond_wait(&pool->start, &pool->lock);
+        bool stop = pool->stopping;
+        seen = pool->generation;
+        PoolJob job = pool->job;
+        void* ctx = pool->ctx;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+
+        job(ctx, helper->worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->finished == pool->threadCount - 1) pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+// ------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// ------------------------------------------------------------------
+WorkPool* PoolCreate(int threadCount) {
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > POOL_MAX_THREADS) threadCount = POOL_MAX_THREADS;
+
+    WorkPool* pool = calloc(1, sizeof(WorkPool));
+    if (!pool) return NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    // Helpers read threadCount only while a job runs, after this is final
+    pool->threadCount = 1;
+    for (int t = 1; t < threadCount; t++) {
+        pool->helpers[t] = (PoolHelper){ pool, t };
+        if (pthread_create(&pool->threads[t], NULL, PoolThread, &pool->helpers[t]) != 0) break;
+        pool->threadCount++;
+    }
+    return pool;
+}
+
+void PoolDestroy(WorkPool* pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 1; t < pool->threadCount; t++) pthread_join(pool->threads[t], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool);
+}
+
+int PoolThreadCount(const WorkPool* pool) {
+    return pool->threadCount;
+}
+
+void PoolRun(WorkPool* pool, PoolJob job, void* ctx) {
+    if (pool->threadCount == 1) {
+        job(ctx, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->ctx = ctx;
+    pool->finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    job(ctx, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->finished < pool->threadCount - 1) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,29 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+// Persistent worker threads for per-tick and per-frame parallel work, where
+// spawning threads each time would cost more than the work itself. The
+// calling thread is worker 0, so a one-thread pool never starts a thread.
+
+typedef struct WorkPool WorkPool;
+
+// Called once on every worker per PoolRun; worker is 0..PoolThreadCount()-1
+typedef void (*PoolJob)(void* ctx, int worker);
+
+#define POOL_MAX_THREADS 64
+
+// Starts threadCount - 1 helper threads (clamped to 1..POOL_MAX_THREADS).
+// If some won't start the pool just runs with fewer. NULL if out of memory.
+WorkPool* PoolCreate(int threadCount);
+
+// Stops and joins the helpers
+void PoolDestroy(WorkPool* pool);
+
+int PoolThreadCount(const WorkPool* pool);
+
+// Runs job on every worker and returns when all of them are done. Everything
+// written before the call is visible to the job, and everything the job
+// wrote is visible after it.
+void PoolRun(WorkPool* pool, PoolJob job, void* ctx);
+
+#endif // WORKPOOL_H